@@ -0,0 +1,273 @@
+//
+//  batch.hpp
+//  EegLinearFilter
+//
+//  Batch mode: many recordings processed concurrently under a global memory budget, scheduled file by file.
+//
+
+#ifndef BATCH_HPP
+#define BATCH_HPP
+
+#include "config.h"
+#include "benchmarks.hpp"
+#include "io/io.hpp"
+#include <dispatch/dispatch.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * One file of a batch with the resources reserved while it runs.
+ */
+struct BatchJob {
+    std::string filePath;
+    std::string outputName;  // Subfolder of the results (file name, made unique within the batch).
+    size_t memoryBytes;  // Estimated peak memory of the run (from the header).
+    size_t inputBytes;   // Bytes of the data records in the file.
+    int cores;           // Share of the cores the file counts against (limits how many files run at once, not its threads).
+};
+
+/**
+ * Scheduler state shared by the dispatching thread and the running files.
+ */
+struct BatchState {
+    std::mutex mutex;
+    std::condition_variable released;
+    size_t freeBytes;
+    int freeCores;
+    int running = 0;
+    int failed = 0;
+    size_t processedInputBytes = 0;
+    std::mutex logMutex;  // Serializes the CSV log and the console.
+    std::mutex gpuMutex;  // One GPU run at a time.
+};
+
+/**
+ * Estimates the peak memory of running the configured mode(s) on a file from its header:
+ * loaded samples, float output buffer and record output (all channels, padded as by the loader),
+ * plus the blocks the loader keeps in flight (IO_QUEUE_DEPTH blocks of whole records).
+ */
+inline size_t estimate_run_bytes(const EdfData& metadata, const AppConfig& config) {
+    size_t samples = 0;
+    for (const int length : metadata.channelLengths) samples += static_cast<size_t>(length) + 2 * KERNEL_RADIUS;
+
+    const bool is24Bit = metadata.records.bytesPerSample == 3;
+    const bool recordOutput = config.recordOutput && !is24Bit;
+    const SampleFormat format = config.runAllVariants ? SampleFormat::ALL : required_sample_format(config.mode.value());
+    const bool inPlace = !config.runAllVariants && filters_in_place(config.mode.value());
+    const bool floatOutput = config.runAllVariants || !recordOutput || !supports_fused_record_output(config.mode.value());
+
+    size_t bytesPerSample = 0;
+    // FP16 samples are narrowed from the physical values, which the loader holds until then.
+    if (format == SampleFormat::FLOAT32 || format == SampleFormat::FLOAT16 || format == SampleFormat::ALL) bytesPerSample += sizeof(float);
+    if (format == SampleFormat::FLOAT16 || format == SampleFormat::ALL) bytesPerSample += sizeof(float16_t);
+    if ((format == SampleFormat::INT16 || format == SampleFormat::ALL) && !is24Bit) bytesPerSample += sizeof(int16_t);
+    // An in-place mode filters the loaded samples themselves.
+    if (floatOutput && !inPlace) bytesPerSample += sizeof(float);
+    if (recordOutput) bytesPerSample += sizeof(int16_t);
+
+    // Same block size and ring depth as the loader (pipelined_read).
+    const size_t bytesPerRecord = metadata.records.recordSize * metadata.records.bytesPerSample;
+    const size_t recordsPerBlock = std::max<size_t>(1, IO_BLOCK_BYTES / std::max<size_t>(bytesPerRecord, 1));
+    const size_t blockCount = (static_cast<size_t>(metadata.records.recordCount) + recordsPerBlock - 1) / recordsPerBlock;
+    const size_t readRingBytes = std::min<size_t>(IO_QUEUE_DEPTH, blockCount) * recordsPerBlock * bytesPerRecord;
+    return samples * bytesPerSample + readRingBytes;
+}
+
+/**
+ * Loads one file of a batch, runs the configured mode(s) and logs every iteration to the CSV.
+ * Results are saved to the subfolder of the file (every file produces the same output names).
+ *
+ * @return One-line summary of the file.
+ */
+std::string run_batch_file(const BatchJob& job, const AppConfig& config, const std::vector<float>& convolutionKernel, BatchState& state) {
+    const auto start = std::chrono::high_resolution_clock::now();
+    const SampleFormat sampleFormat = config.runAllVariants ? SampleFormat::ALL : required_sample_format(config.mode.value());
+    EdfData loadedData = load_edf_data(job.filePath.c_str(), KERNEL_RADIUS, sampleFormat);
+    const double loadSec = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+    const bool is24Bit = loadedData.records.bytesPerSample == 3;
+    const bool recordOutput = config.recordOutput && !is24Bit;
+    const std::string inputFilename = fs::path(job.filePath).filename().string();
+    const std::string outputFolderPath = config.outputFolderPath + job.outputName + "/";
+
+    std::vector<ProcessingMode> modes;
+    for (int i = 0; i < (int)ProcessingMode::COUNT; ++i) {
+        const ProcessingMode mode = static_cast<ProcessingMode>(i);
+        if (!config.runAllVariants && mode != config.mode.value()) continue;
+        if (is24Bit && requires_16bit_samples(mode)) continue;
+        modes.push_back(mode);
+    }
+
+    // Same buffer handling as a single-file run.
+    int iterationCount = config.iterationCount;
+    const bool floatOutputNeeded = config.runAllVariants || !recordOutput || !supports_fused_record_output(config.mode.value());
+    NeonVector outputBuffer;
+    if (!config.runAllVariants && filters_in_place(config.mode.value())) {
+        outputBuffer = std::move(loadedData.samples);
+        iterationCount = 1;
+    } else {
+        outputBuffer.assign(floatOutputNeeded ? loadedData.totalSamplesPadded : 0, 0.0f);
+    }
+
+    double runSec = 0.0;
+    for (const ProcessingMode mode : modes) {
+        EdfRecordOutput records;
+        if (recordOutput) {
+            records = create_run_records(mode, loadedData, convolutionKernel, config.saveResults, outputFolderPath);
+        }
+
+        for (int i = 0; i < iterationCount; ++i) {
+            ProcessingStats stats;
+            if (runs_on_gpu(mode)) {
+                std::lock_guard<std::mutex> lock(state.gpuMutex);
+                stats = run_processor<KERNEL_RADIUS, CHUNK_SIZE, K_BATCH>(mode, loadedData, outputBuffer, convolutionKernel, recordOutput ? &records : nullptr);
+            } else {
+                stats = run_processor<KERNEL_RADIUS, CHUNK_SIZE, K_BATCH>(mode, loadedData, outputBuffer, convolutionKernel, recordOutput ? &records : nullptr);
+            }
+            runSec += stats.totalTimeSec;
+
+            std::lock_guard<std::mutex> lock(state.logMutex);
+            log_benchmark_result<KERNEL_RADIUS>(std::string(magic_enum::enum_name(mode)), inputFilename, loadedData.totalSamplesPadded - (2 * KERNEL_RADIUS), i + 1, iterationCount, stats);
+        }
+
+        if (config.saveResults) {
+            // The exporters print their progress, so a save holds the console like a log line (exports of concurrent files take turns).
+            std::lock_guard<std::mutex> lock(state.logMutex);
+            save_run_results(mode, loadedData, outputBuffer, convolutionKernel, records, recordOutput, outputFolderPath);
+        }
+    }
+
+    const double totalSec = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    std::ostringstream summary;
+    summary << inputFilename << ": " << (job.memoryBytes / 1024 / 1024) << " MB, " << job.cores << " core share | load " << loadSec
+            << "s | " << modes.size() << " mode(s) x " << iterationCount << " run(s) " << runSec << "s | total " << totalSec << "s";
+    return summary.str();
+}
+
+/**
+ * Processes all files of a batch (AppConfig::batchFiles) with the configured mode(s).
+ * Every file's memory need is estimated from its header. Files run concurrently as long as their estimates fit
+ * BATCH_MEMORY_FRACTION of the physical memory and their core shares fit the cores: a file counts against a share
+ * in proportion to its size (BATCH_ALL_CORES_BYTES and more take all cores), so many small files run side by side
+ * while a large file runs alone. The shares only limit admission, every file's modes still spread over all cores.
+ * The largest pending file that fits starts first, a file beyond the whole budget runs alone. Buffers cached by the
+ * pool (at most BUFFER_POOL_MAX_CACHED_BYTES) are reused by the next files and trimmed whenever no file is running. Results are appended to the CSV log
+ * as every run finishes.
+ */
+void run_batch(const AppConfig& config, const std::vector<float>& convolutionKernel) {
+    const int coreCount = static_cast<int>(std::max(1L, sysconf(_SC_NPROCESSORS_ONLN)));
+    const size_t physicalBytes = static_cast<size_t>(sysconf(_SC_PHYS_PAGES)) * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t budget = static_cast<size_t>(physicalBytes * BATCH_MEMORY_FRACTION);
+
+    std::vector<BatchJob> pending;
+    std::set<std::string> outputNames;
+    size_t totalBytes = 0;
+    int skipped = 0;
+    for (const std::string& filePath : config.batchFiles) {
+        try {
+            const EdfData metadata = read_edf_metadata(filePath.c_str());
+            const size_t bytes = estimate_run_bytes(metadata, config);
+            const int cores = static_cast<int>(std::ceil(static_cast<double>(coreCount) * bytes / BATCH_ALL_CORES_BYTES));
+            const bool exclusive = !config.runAllVariants && runs_on_gpu(config.mode.value());
+
+            // Files of the same name (other folders / extensions) get numbered subfolders.
+            const std::string stem = fs::path(filePath).stem().string();
+            std::string outputName = stem;
+            for (int n = 2; !outputNames.insert(outputName).second; ++n) outputName = stem + "_" + std::to_string(n);
+
+            const size_t inputBytes = static_cast<size_t>(metadata.records.recordCount) * metadata.records.recordSize * metadata.records.bytesPerSample;
+            pending.push_back({filePath, outputName, bytes, inputBytes, exclusive ? coreCount : std::clamp(cores, 1, coreCount)});
+            totalBytes += bytes;
+        } catch (const std::exception& e) {
+            std::cout << "Skipping " << filePath << ": " << e.what() << std::endl;
+            ++skipped;
+        }
+    }
+    std::sort(pending.begin(), pending.end(), [](const BatchJob& a, const BatchJob& b) { return a.memoryBytes > b.memoryBytes; });
+    const size_t fileCount = pending.size() + static_cast<size_t>(skipped);
+
+    std::cout << "Batch: " << pending.size() << " file(s), " << (totalBytes / 1024 / 1024) << " MB estimated | Budget: "
+              << (budget / 1024 / 1024) << " MB | Cores: " << coreCount << std::endl;
+    std::cout << "========================================\n";
+
+    BatchState state;
+    state.freeBytes = budget;
+    state.freeCores = coreCount;
+    state.failed = skipped;
+
+    BatchState* statePtr = &state;
+    const AppConfig* configPtr = &config;
+    const std::vector<float>* kernelPtr = &convolutionKernel;
+    dispatch_group_t group = dispatch_group_create();
+    dispatch_queue_t queue = dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0);
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    while (!pending.empty()) {
+        std::unique_lock<std::mutex> lock(state.mutex);
+        auto next = pending.end();
+        state.released.wait(lock, [&] {
+            next = std::find_if(pending.begin(), pending.end(), [&](const BatchJob& job) {
+                return state.running == 0 || (job.memoryBytes <= state.freeBytes && job.cores <= state.freeCores);
+            });
+            return next != pending.end();
+        });
+
+        const BatchJob job = *next;
+        pending.erase(next);
+        // A file beyond the whole budget runs alone and takes all of it.
+        const size_t reservedBytes = std::min(job.memoryBytes, state.freeBytes);
+        state.freeBytes -= reservedBytes;
+        state.freeCores -= job.cores;
+        ++state.running;
+        lock.unlock();
+
+        dispatch_group_async(group, queue, ^{
+            std::string summary;
+            bool ok = true;
+            try {
+                summary = run_batch_file(job, *configPtr, *kernelPtr, *statePtr);
+            } catch (const std::exception& e) {
+                summary = job.filePath + ": failed: " + e.what();
+                ok = false;
+            }
+
+            {
+                std::lock_guard<std::mutex> stateLock(statePtr->mutex);
+                statePtr->freeBytes += reservedBytes;
+                statePtr->freeCores += job.cores;
+                --statePtr->running;
+                if (ok) statePtr->processedInputBytes += job.inputBytes;
+                else ++statePtr->failed;
+                // Other running files may still use cached buffers, so the pool is only trimmed once none is in flight
+                // (no file can start while the state lock is held).
+                if (statePtr->running == 0) BufferPool::get().trim();
+            }
+            statePtr->released.notify_all();
+
+            std::lock_guard<std::mutex> logLock(statePtr->logMutex);
+            std::cout << summary << std::endl;
+        });
+    }
+
+    dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+    dispatch_release(group);
+
+    const double wallSec = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    std::cout << "========================================\n";
+    // Skipped files (unreadable header) count as failed.
+    std::cout << "Batch finished: " << (fileCount - static_cast<size_t>(state.failed)) << "/" << fileCount
+              << " file(s) in " << wallSec << "s";
+    if (wallSec > 0.0) std::cout << " | " << (state.processedInputBytes / 1024.0 / 1024.0 / wallSec) << " MB/s of input data";
+    std::cout << std::endl;
+}
+
+#endif // BATCH_HPP
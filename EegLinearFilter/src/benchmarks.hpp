@@ -17,6 +17,8 @@
 #include <fstream>
 #include <filesystem>
 #include <ctime>
+#include <cmath>
+#include <algorithm>
 
 namespace fs = std::filesystem;
 
@@ -73,9 +75,10 @@ void log_benchmark_result(const std::string& mode, const std::string& filename,
  *
  * @param stats Vector containing statistics for each benchmark run.
  * @param dataSize Total size of the input data.
+ * @param pageFaults Page faults of the process summed over all runs.
  */
 template <int Radius>
-void calc_benchmarks(const std::vector<ProcessingStats>& stats, size_t dataSize) {
+void calc_benchmarks(const std::vector<ProcessingStats>& stats, size_t dataSize, const long long pageFaults) {
     constexpr size_t KernelSize = 2 * Radius + 1;
     const size_t outputElements = dataSize - KernelSize + 1;
     
@@ -120,9 +123,191 @@ void calc_benchmarks(const std::vector<ProcessingStats>& stats, size_t dataSize)
     std::cout << "Metrics:" << std::endl;
     std::cout << "  Throughput: " << megaSamplesPerSec << " MSamples/s" << std::endl;
     std::cout << "  Performance: " << gigaFlops << " GFLOPS" << std::endl;
+    std::cout << "  Page faults: " << (pageFaults / static_cast<long long>(stats.size())) << " per run" << std::endl;
     std::cout << "========================================\n";
 }
 
+/**
+ * Checks whether the mode approximates the convolution, evaluates it in transformed arithmetic, at reduced precision
+ * or with a different accumulation (plain vs compensated FP32, compared against the FP64 reference).
+ * Accuracy of these modes is measured against ACCURACY_REFERENCE_MODE after the benchmark runs.
+ *
+ * @param mode The processing mode.
+ * @return True if the accuracy of the mode should be reported.
+ */
+bool reports_accuracy(const ProcessingMode mode) {
+    switch (mode) {
+        case ProcessingMode::CPU_SEQ_MANUAL_VEC:
+        case ProcessingMode::CPU_SEQ_WINOGRAD:
+        case ProcessingMode::CPU_SEQ_FP16:
+        case ProcessingMode::CPU_SEQ_INT16:
+        case ProcessingMode::CPU_SEQ_NEUMAIER:
+        case ProcessingMode::CPU_SEQ_MANUAL_VEC_NT:
+        case ProcessingMode::CPU_PAR_MANUAL_VEC:
+        case ProcessingMode::CPU_PAR_WINOGRAD:
+        case ProcessingMode::CPU_PAR_FP16:
+        case ProcessingMode::CPU_PAR_INT16:
+        case ProcessingMode::CPU_PAR_FFT_BATCHED:
+        case ProcessingMode::CPU_PAR_NEUMAIER:
+        case ProcessingMode::CPU_PAR_IN_PLACE:
+        case ProcessingMode::CPU_PAR_MANUAL_VEC_NT:
+        case ProcessingMode::CPU_PAR_MULTIRATE:
+        case ProcessingMode::CPU_PAR_BOX_CASCADE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * Compares a result against a reference over the valid samples of every channel.
+ *
+ * @param result Output of the evaluated mode.
+ * @param reference Output of the reference mode.
+ * @param loadedData Input data (provides the channel layout).
+ * @return AccuracyStats with absolute, RMS and relative errors.
+ */
+AccuracyStats calc_accuracy(const NeonVector& result, const NeonVector& reference, const EdfData& loadedData) {
+    double maxAbsError = 0.0;
+    double maxReference = 0.0;
+    double sumSquares = 0.0;
+    size_t count = 0;
+
+    for (int s = 0; s < loadedData.header.num_signals; ++s) {
+        const size_t channelStart = loadedData.channelStarts[s];
+        for (size_t i = channelStart; i < channelStart + loadedData.channelLengths[s]; ++i) {
+            const double diff = std::abs(static_cast<double>(result[i]) - reference[i]);
+            maxAbsError = std::max(maxAbsError, diff);
+            maxReference = std::max(maxReference, std::abs(static_cast<double>(reference[i])));
+            sumSquares += diff * diff;
+            ++count;
+        }
+    }
+
+    return {
+        maxAbsError,
+        (count > 0) ? std::sqrt(sumSquares / count) : 0.0,
+        (maxReference > 0.0) ? maxAbsError / maxReference : maxAbsError
+    };
+}
+
+/**
+ * Appends the accuracy of a mode to a CSV file in the logs directory.
+ *
+ * @param mode The evaluated processing mode.
+ * @param referenceMode The mode used as the reference.
+ * @param filename Name of the processed file.
+ * @param accuracy Measured errors.
+ */
+template <int Radius>
+void log_accuracy_result(const std::string& mode, const std::string& referenceMode, const std::string& filename, const AccuracyStats& accuracy) {
+    if (!fs::exists(LOGS_DIR)) {
+        fs::create_directory(LOGS_DIR);
+    }
+
+    std::string csv_path = std::string(LOGS_DIR) + "/accuracy_results.csv";
+    bool file_exists = fs::exists(csv_path);
+
+    std::ofstream log_file(csv_path, std::ios::app);
+
+    if (!file_exists) {
+        log_file << "Timestamp;Mode;ReferenceMode;Filename;KernelRadius;MaxAbsError;RmsError;MaxRelError;WithinTolerance\n";
+    }
+
+    std::time_t now = std::time(nullptr);
+    char time_buffer[100];
+    if (std::strftime(time_buffer, sizeof(time_buffer), "%Y-%m-%d %H:%M:%S", std::localtime(&now))) {
+        log_file << time_buffer << ";"
+                << mode << ";"
+                << referenceMode << ";"
+                << filename << ";"
+                << Radius << ";"
+                << std::scientific << std::setprecision(6)
+                << accuracy.maxAbsError << ";"
+                << accuracy.rmsError << ";"
+                << accuracy.maxRelError << ";"
+                << (accuracy.maxRelError <= ACCURACY_TOLERANCE ? 1 : 0) << "\n";
+    }
+}
+
+/**
+ * Runs the reference mode, measures the error of the last result of the benchmarked mode,
+ * prints it and logs it.
+ *
+ * @param mode The evaluated processing mode.
+ * @param inputFilename Name of the input file for logging purposes.
+ * @param loadedData struct containing input samples and metadata.
+ * @param outputBuffer Result of the evaluated mode.
+ * @param convolutionKernel The 1D kernel weights.
+ */
+void report_accuracy(const ProcessingMode mode, const std::string& inputFilename, const EdfData& loadedData, const NeonVector& outputBuffer, const std::vector<float>& convolutionKernel) {
+    const ProcessingMode referenceMode = ACCURACY_REFERENCE_MODE;
+    
+    if (loadedData.samples.empty()) {
+        std::cout << "Accuracy vs " << magic_enum::enum_name(referenceMode) << ": skipped (physical samples not in memory)" << std::endl;
+        std::cout << "========================================\n";
+        return;
+    }
+    
+    NeonVector referenceBuffer(outputBuffer.size(), 0.0f);
+    run_processor<KERNEL_RADIUS, CHUNK_SIZE, K_BATCH>(referenceMode, loadedData, referenceBuffer, convolutionKernel);
+    
+    const AccuracyStats accuracy = calc_accuracy(outputBuffer, referenceBuffer, loadedData);
+    log_accuracy_result<KERNEL_RADIUS>(
+        std::string(magic_enum::enum_name(mode)),
+        std::string(magic_enum::enum_name(referenceMode)),
+        inputFilename,
+        accuracy
+    );
+    
+    std::cout << "Accuracy vs " << magic_enum::enum_name(referenceMode) << ":" << std::endl;
+    std::cout << "  Max abs error: " << accuracy.maxAbsError << std::endl;
+    std::cout << "  RMS error: " << accuracy.rmsError << std::endl;
+    std::cout << "  Max rel error: " << accuracy.maxRelError
+              << (accuracy.maxRelError <= ACCURACY_TOLERANCE ? " (within tolerance)" : " (EXCEEDS tolerance)") << std::endl;
+    std::cout << "========================================\n";
+}
+
+// Output file of the results of a mode (extension by OUTPUT_FORMAT and the sample width of the source).
+inline std::string result_filename(const ProcessingMode mode, const EdfData& loadedData, const std::string& outputFolderPath) {
+    std::string extension = (loadedData.records.bytesPerSample == 3) ? ".bdf" : ".edf";
+    if (OUTPUT_FORMAT == OutputFormat::COLUMNAR) extension = ".eegc";
+    return outputFolderPath + std::string(magic_enum::enum_name(mode)) + extension;
+}
+
+/**
+ * Allocates the record output of a run. Records that will be saved as EDF are mapped straight into the
+ * output file (MAPPED_EDF_OUTPUT), so the workers write them in place.
+ */
+EdfRecordOutput create_run_records(const ProcessingMode mode, const EdfData& loadedData, const std::vector<float>& convolutionKernel, const bool save_results, const std::string& outputFolderPath) {
+    if (save_results && OUTPUT_FORMAT == OutputFormat::EDF && MAPPED_EDF_OUTPUT) {
+        return create_mapped_record_output(loadedData, convolutionKernel.size(), result_filename(mode, loadedData, outputFolderPath));
+    }
+    return create_record_output(loadedData, convolutionKernel.size());
+}
+
+/**
+ * Saves the results of a run in OUTPUT_FORMAT: the records when the run quantized into records, the float output otherwise.
+ */
+void save_run_results(const ProcessingMode mode, const EdfData& loadedData, const NeonVector& outputBuffer, const std::vector<float>& convolutionKernel, EdfRecordOutput& records, const bool record_output, const std::string& outputFolderPath) {
+    const std::string outputFilename = result_filename(mode, loadedData, outputFolderPath);
+
+    if (OUTPUT_FORMAT == OutputFormat::COLUMNAR) {
+        if (record_output) {
+            save_columnar_records(records, outputFilename, loadedData);
+        } else {
+            save_columnar(outputBuffer, outputFilename, convolutionKernel, loadedData);
+        }
+    } else if (records.file) {
+        std::cout << "Exporting EDF records: " << outputFilename << " (written in place)" << std::endl;
+        finish_mapped_records(records);
+    } else if (record_output) {
+        save_records(records, outputFilename, loadedData);
+    } else {
+        save_data(outputBuffer, outputFilename, convolutionKernel, loadedData);
+    }
+}
+
 /**
  * Orchestrates the benchmark execution loop for a specific processing mode.
  * Runs the processor multiple times, logs results, calculates averages, and optionally saves output.
@@ -135,18 +320,30 @@ void calc_benchmarks(const std::vector<ProcessingStats>& stats, size_t dataSize)
  * @param benchmark_iteration_count Number of times to repeat the benchmark.
  * @param save_results Flag indicating whether to save the filtered data to disk.
  * @param outputFolderPath Directory path where the output file should be saved.
+ * @param record_output Flag indicating whether results are quantized into EDF records (saved as-is).
  */
-void run_benchmark(const ProcessingMode mode, const std::string& inputFilename, const EdfData& loadedData, NeonVector& outputBuffer, const std::vector<float>& convolutionKernel, const int benchmark_iteration_count, const bool save_results, const std::string& outputFolderPath) {
+void run_benchmark(const ProcessingMode mode, const std::string& inputFilename, const EdfData& loadedData, NeonVector& outputBuffer, const std::vector<float>& convolutionKernel, const int benchmark_iteration_count, const bool save_results, const std::string& outputFolderPath, const bool record_output) {
     std::cout << "Mode: " << magic_enum::enum_name(mode) << std::endl;
     std::cout << "----------------------------------------\n";
     
-    const size_t dataSize = loadedData.samples.size();
+    const size_t dataSize = loadedData.totalSamplesPadded;
     std::vector<ProcessingStats> stats_collection(benchmark_iteration_count);
     
+    EdfRecordOutput records;
+    if (record_output) {
+        records = create_run_records(mode, loadedData, convolutionKernel, save_results, outputFolderPath);
+    }
+    // Fused output stages write the records only, the float buffer keeps stale data.
+    const bool floatOutputValid = !(record_output && supports_fused_record_output(mode));
+    
+    long long pageFaults = 0;
+    
     for (int i = 0; i < benchmark_iteration_count; ++i) {
         std::cout << "Run " << (i + 1) << ": running..." << std::flush;
         
-        ProcessingStats stats = run_processor<KERNEL_RADIUS, CHUNK_SIZE, K_BATCH>(mode, loadedData.samples, outputBuffer, convolutionKernel);
+        const long long faultsBefore = process_page_faults();
+        ProcessingStats stats = run_processor<KERNEL_RADIUS, CHUNK_SIZE, K_BATCH>(mode, loadedData, outputBuffer, convolutionKernel, record_output ? &records : nullptr);
+        pageFaults += process_page_faults() - faultsBefore;
         log_benchmark_result<KERNEL_RADIUS>(
             std::string(magic_enum::enum_name(mode)),
             inputFilename,
@@ -166,11 +363,14 @@ void run_benchmark(const ProcessingMode mode, const std::string& inputFilename,
         stats_collection[i] = stats;
     }
     
-    calc_benchmarks<KERNEL_RADIUS>(stats_collection, dataSize);
+    calc_benchmarks<KERNEL_RADIUS>(stats_collection, dataSize, pageFaults);
+    
+    if (reports_accuracy(mode) && floatOutputValid) {
+        report_accuracy(mode, inputFilename, loadedData, outputBuffer, convolutionKernel);
+    }
     
     if (save_results) {
-        std::string outputFilename = outputFolderPath + std::string(magic_enum::enum_name(mode)) + ".edf";
-        save_data(outputBuffer, outputFilename, convolutionKernel, loadedData);
+        save_run_results(mode, loadedData, outputBuffer, convolutionKernel, records, record_output, outputFolderPath);
     }
 }
 
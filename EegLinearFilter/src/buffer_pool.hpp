@@ -0,0 +1,146 @@
+//
+//  buffer_pool.hpp
+//  EegLinearFilter
+//
+//  Size-class pool of aligned buffers reused across files, modes and iterations.
+//
+
+#ifndef BUFFER_POOL_HPP
+#define BUFFER_POOL_HPP
+
+#include "config.h"
+#include "page_faults.hpp"
+#include <stdlib.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <new>
+#include <vector>
+
+/**
+ * Counters of the buffer pool since the start of the application.
+ */
+struct BufferPoolStats {
+    size_t requests = 0;        // Buffers handed out
+    size_t reuses = 0;          // ... of which came from the free lists
+    size_t bytesAllocated = 0;  // Bytes newly allocated from the OS
+    size_t bytesReused = 0;     // Bytes handed out again without touching the OS
+    size_t bytesCached = 0;     // Bytes currently kept in the free lists
+};
+
+/**
+ * Process-wide pool of aligned buffers backing aligned_allocator.
+ *
+ * Requests are rounded up to size classes (8 classes per power of two, so at most 12.5 % slack)
+ * and released buffers are kept in per-class free lists. Re-creating the output buffer or the
+ * per-run temporaries of the next mode or iteration therefore takes already faulted memory
+ * instead of new pages. Large fresh buffers are pre-faulted (PREFAULT_BUFFERS).
+ * Cached memory is capped by BUFFER_POOL_MAX_CACHED_BYTES, and the app trims the pool once a file
+ * (or every file of a batch) is done.
+ */
+class BufferPool {
+public:
+    static constexpr size_t Alignment = 16384;
+
+    static BufferPool& get() {
+        // Never destroyed, so containers released during static destruction remain valid.
+        static BufferPool* instance = new BufferPool();
+        return *instance;
+    }
+
+    static size_t size_class(const size_t bytes) {
+        constexpr size_t MinClass = 4096;
+        if (bytes <= MinClass) return MinClass;
+        size_t power = MinClass;
+        while (power * 2 <= bytes) power *= 2;
+        const size_t step = std::max(power / 8, MinClass);
+        return (bytes + step - 1) / step * step;
+    }
+
+    void* acquire(const size_t bytes) {
+        const size_t classBytes = size_class(bytes);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++stats.requests;
+            auto it = freeLists.find(classBytes);
+            if (BUFFER_POOL_ENABLED && it != freeLists.end() && !it->second.empty()) {
+                void* buffer = it->second.back();
+                it->second.pop_back();
+                ++stats.reuses;
+                stats.bytesReused += classBytes;
+                stats.bytesCached -= classBytes;
+                return buffer;
+            }
+            stats.bytesAllocated += classBytes;
+        }
+        return allocate_fresh(classBytes);
+    }
+
+    void release(void* buffer, const size_t bytes) noexcept {
+        const size_t classBytes = size_class(bytes);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (BUFFER_POOL_ENABLED && stats.bytesCached + classBytes <= BUFFER_POOL_MAX_CACHED_BYTES) {
+                freeLists[classBytes].push_back(buffer);
+                stats.bytesCached += classBytes;
+                return;
+            }
+            ++osReleases;
+        }
+        free(buffer);
+    }
+
+    /**
+     * Returns all cached buffers to the OS.
+     */
+    void trim() {
+        std::map<size_t, std::vector<void*>> released;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            released.swap(freeLists);
+            stats.bytesCached = 0;
+            ++osReleases;
+        }
+        for (auto& [classBytes, buffers] : released) {
+            for (void* buffer : buffers) free(buffer);
+        }
+    }
+
+    BufferPoolStats snapshot() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return stats;
+    }
+
+    /**
+     * Changes whenever memory goes back to the OS. Wrappers of pooled memory (Metal no-copy buffers)
+     * are only valid while the generation is unchanged.
+     */
+    size_t generation() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return osReleases;
+    }
+
+private:
+    BufferPool() = default;
+
+    static void* allocate_fresh(const size_t bytes) {
+        void* buffer;
+        if (posix_memalign(&buffer, Alignment, bytes) != 0) {
+            throw std::bad_alloc();
+        }
+
+        if (PREFAULT_BUFFERS && bytes >= PREFAULT_MIN_BYTES) {
+            prefault_pages(buffer, bytes);
+        }
+        return buffer;
+    }
+
+    std::mutex mutex;
+    std::map<size_t, std::vector<void*>> freeLists;
+    BufferPoolStats stats;
+    size_t osReleases = 0;
+};
+
+#endif // BUFFER_POOL_HPP
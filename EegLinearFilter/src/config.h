@@ -13,6 +13,7 @@
 // 1. CONFIG CONSTANTS
 // ==========================================
 
+// New modes are appended (before COUNT), so the index of an existing mode never changes.
 enum class ProcessingMode {
     CPU_SEQ_APPLE,           // Sequential benchmark implementation using Apple vDSP_conv method
     CPU_SEQ_NAIVE,           // Sequential naive approach without optimization
@@ -25,10 +26,34 @@ enum class ProcessingMode {
     CPU_PAR_MANUAL_VEC,      // Parallel, manual vectorization
     GPU_NAIVE,               // GPU-accelerated naive approach
     GPU_32BIT,               // GPU-accelerated (32-bit precision)
+    CPU_PAR_MULTIRATE,       // Parallel multi-rate (pyramid) Gaussian approximation
+    CPU_PAR_BOX_CASCADE,     // Parallel box-filter cascade (running sums) Gaussian approximation
+    CPU_SEQ_TOEPLITZ_GEMM,   // Sequential, Toeplitz-GEMM with a register-tiled micro-kernel
+    CPU_PAR_TOEPLITZ_GEMM,   // Parallel, Toeplitz-GEMM with a register-tiled micro-kernel
+    CPU_SEQ_WINOGRAD,        // Sequential, Winograd F(m, 3) minimal filtering over kernel segments
+    CPU_PAR_WINOGRAD,        // Parallel, Winograd F(m, 3) minimal filtering over kernel segments
+    CPU_PAR_FFT_BATCHED,     // Parallel, overlap-save FFT batched over channels in Neon lanes
+    CPU_SEQ_FP16,            // Sequential, FP16 storage of samples and outputs, FP32 accumulation
+    CPU_PAR_FP16,            // Parallel, FP16 storage of samples and outputs, FP32 accumulation
+    CPU_SEQ_INT16,           // Sequential, fixed-point on raw int16 digital samples, int32 accumulation
+    CPU_PAR_INT16,           // Parallel, fixed-point on raw int16 digital samples, int32 accumulation
+    CPU_PAR_FUSED_DECODE,    // Parallel, tiles decode int16 samples straight from the mmapped EDF records
+    CPU_SEQ_NEUMAIER,        // Sequential, manual vectorization with compensated (Neumaier) FP32 accumulation
+    CPU_SEQ_FP64_ACC,        // Sequential, manual vectorization with FP64 accumulation
+    CPU_PAR_NEUMAIER,        // Parallel, manual vectorization with compensated (Neumaier) FP32 accumulation
+    CPU_PAR_FP64_ACC,        // Parallel, manual vectorization with FP64 accumulation
+    CPU_PAR_IN_PLACE,        // Parallel, manual vectorization overwriting the input (per-chunk boundary history)
+    CPU_SEQ_MANUAL_VEC_NT,   // Sequential, manual vectorization, outputs written once with non-temporal stores + prefetch
+    CPU_PAR_MANUAL_VEC_NT,   // Parallel, manual vectorization, outputs written once with non-temporal stores + prefetch
     
     COUNT
 };
 
+enum class OutputFormat {
+    EDF,         // EDF+ / BDF+ (plain EDF records with record output), readable by any EDF viewer
+    COLUMNAR     // Per-channel chunks compressed with bit-packed residuals, chunk index for random access (.eegc)
+};
+
 #define LOGS_DIR "EegLinearFilter/logs"
 
 // --- Default app config ---
@@ -37,8 +62,10 @@ enum class ProcessingMode {
 #define DEFAULT_FILE_DOWNLOAD_URL "https://physionet-open.s3.amazonaws.com/siena-scalp-eeg/1.0.0/PN01/PN01-1.edf?download"
 #define DEFAULT_ITERATIONS 10
 #define DEFAULT_SAVE false
+#define DEFAULT_RECORD_OUTPUT false // Quantize results straight into EDF data records (int16) instead of a float buffer.
 #define DEFAULT_OUT_DIR "EegLinearFilter/out/"
 #define DEFAULT_MODE_INDEX -1
+#define DEFAULT_FOLLOW false // Follow the input file as it grows (live recording) instead of benchmarking it.
 
 // --- Convolution kernel parameters ---
 #define KERNEL_RADIUS 256
@@ -47,6 +74,48 @@ enum class ProcessingMode {
 // --- CPU parameters ---
 #define CHUNK_SIZE 8192 // NOTE: must be a multiple of 16 for optimal NEON alignment.
 #define K_BATCH 32
+#define PREFETCH_DISTANCE CHUNK_SIZE // Samples ahead of the current output prefetched by the NT modes (CHUNK_SIZE = next chunk).
+#define GEMM_MR 16 // Neon accumulators in the Toeplitz-GEMM register tile (tile = GEMM_MR x 4 outputs).
+#define FFT_SIZE 4096 // Overlap-save block length, yields FFT_SIZE - 2 * KERNEL_RADIUS outputs per channel and block.
+#define WINOGRAD_TILE 4 // Outputs per Winograd F(m, 3) tile and lane. F(4, 3) max rel. error ~1e-6 vs CPU_PAR_FP64_ACC (sigma 1-60), well within ACCURACY_TOLERANCE.
+
+// --- Memory parameters ---
+#define PREFAULT_BUFFERS true // Fault in large buffers with a parallel first touch right after allocation.
+#define PREFAULT_MIN_BYTES (64 * 1024 * 1024) // Smaller buffers are faulted in by their first write.
+#define BUFFER_POOL_ENABLED true // Keep released aligned buffers for reuse by later modes and iterations of a file (trimmed once no file is running).
+#define BUFFER_POOL_MAX_CACHED_BYTES (1ULL * 1024 * 1024 * 1024) // Released buffers beyond this go back to the OS.
+
+// --- I/O parameters ---
+#define IO_BLOCK_BYTES (4 * 1024 * 1024) // Max. bytes per positioned read / write of whole data records (loader, record export).
+#define IO_QUEUE_DEPTH 4 // Blocks kept in flight by the asynchronous reader / writer (1 = read, then decode).
+#define IO_DIRECT_READS false // Bypass the page cache when loading (O_DIRECT / F_NOCACHE), for cold-dataset benchmarks.
+#define SAMPLE_CACHE_ENABLED false // Keep the decoded (padded float32 / int16) samples in a sidecar file, read back by later loads.
+#define SAMPLE_CACHE_DIR "EegLinearFilter/cache"
+
+// --- Follow mode (growing recordings) parameters ---
+#define FOLLOW_POLL_INTERVAL_MS 1000 // Max. time between two checks of the file size (writes reported by the OS wake the follower earlier).
+#define FOLLOW_IDLE_TIMEOUT_SEC 60 // Follow mode ends when the recording has not grown for this long.
+
+// --- Batch mode parameters ---
+#define BATCH_MEMORY_FRACTION 0.5 // Share of the physical memory the files processed concurrently may take (estimated from their headers).
+#define BATCH_ALL_CORES_BYTES (512ULL * 1024 * 1024) // Files estimated at this much memory or more reserve all cores, smaller files a proportional share.
+
+// --- Output format parameters ---
+#define OUTPUT_FORMAT OutputFormat::EDF
+#define MAPPED_EDF_OUTPUT false // EDF exports of 16-bit sources are quantized by the parallel workers straight into the mapped output file (plain EDF instead of EDF+, start time in whole seconds).
+#define MAPPED_OUTPUT_SYNC false // msync + fsync the mapped output before returning (otherwise the kernel writes it back later).
+#define COLUMNAR_LOSSLESS_FLOAT false // Keep the float32 output bit-exact (XOR residuals) instead of quantizing it to the digital range like the EDF export.
+#define COLUMNAR_CHUNK_SAMPLES 65536 // Samples per independently decodable chunk. NOTE: must be a multiple of 128 (bit-packing block).
+
+// --- Multi-rate (pyramid) Gaussian parameters ---
+#define MULTIRATE_TOLERANCE 1e-3f // Max. Gaussian spectrum magnitude allowed at the decimated Nyquist frequency.
+
+// --- Box-filter cascade parameters ---
+#define BOX_CASCADE_PASSES 3
+
+// --- Accuracy reporting ---
+#define ACCURACY_REFERENCE_MODE ProcessingMode::CPU_PAR_FP64_ACC // FP64 accumulation, so FP32 modes are measured against a more accurate result.
+#define ACCURACY_TOLERANCE 1e-4 // Max. error relative to the peak reference magnitude.
 
 // --- GPU parameters ---
 #define THREADS_PER_GROUP 256 // NOTE: must be a multiple of 32 (Apple GPU SIMD width).
@@ -73,6 +142,39 @@ static_assert(CHUNK_SIZE > 0, "CHUNK_SIZE must be greater than 0.");
 static_assert(K_BATCH > 0, "K_BATCH must be greater than 0.");
 static_assert(K_BATCH % 4 == 0, "K_BATCH must be divisible by 4 (due to manual unrolling stride).");
 static_assert(K_BATCH == 32, "K_BATCH must be 32 due to the implementation of manually vectorized algorithms..");
+static_assert(PREFETCH_DISTANCE >= 0 && PREFETCH_DISTANCE % 16 == 0, "PREFETCH_DISTANCE must be a non-negative multiple of 16 (one prefetch per 16 outputs).");
+static_assert(GEMM_MR == 8 || GEMM_MR == 16, "GEMM_MR must be 8 or 16 (register budget of the Toeplitz-GEMM micro-kernel).");
+static_assert((FFT_SIZE & (FFT_SIZE - 1)) == 0, "FFT_SIZE must be a power of two.");
+static_assert(FFT_SIZE >= 2 * (2 * KERNEL_RADIUS + 1), "FFT_SIZE must be at least twice the kernel size (otherwise most of every block is discarded).");
+static_assert(WINOGRAD_TILE == 2 || WINOGRAD_TILE == 4, "WINOGRAD_TILE must be 2 or 4 (only F(2, 3) and F(4, 3) are implemented).");
+
+// --- Memory parameters ---
+static_assert(PREFAULT_MIN_BYTES > 0, "PREFAULT_MIN_BYTES must be positive.");
+static_assert(!BUFFER_POOL_ENABLED || BUFFER_POOL_MAX_CACHED_BYTES > 0, "BUFFER_POOL_MAX_CACHED_BYTES must be positive (disable the pool with BUFFER_POOL_ENABLED instead).");
+
+// --- I/O parameters ---
+static_assert(IO_BLOCK_BYTES > 0, "IO_BLOCK_BYTES must be positive.");
+static_assert(IO_QUEUE_DEPTH >= 1 && IO_QUEUE_DEPTH <= 64, "IO_QUEUE_DEPTH must be between 1 and 64.");
+
+// --- Follow mode (growing recordings) parameters ---
+static_assert(FOLLOW_POLL_INTERVAL_MS > 0, "FOLLOW_POLL_INTERVAL_MS must be positive.");
+static_assert(FOLLOW_IDLE_TIMEOUT_SEC > 0, "FOLLOW_IDLE_TIMEOUT_SEC must be positive.");
+
+// --- Batch mode parameters ---
+static_assert(BATCH_MEMORY_FRACTION > 0.0 && BATCH_MEMORY_FRACTION <= 1.0, "BATCH_MEMORY_FRACTION must be in range (0, 1].");
+static_assert(BATCH_ALL_CORES_BYTES > 0, "BATCH_ALL_CORES_BYTES must be positive.");
+
+// --- Output format parameters ---
+static_assert(COLUMNAR_CHUNK_SAMPLES > 0 && COLUMNAR_CHUNK_SAMPLES % 128 == 0, "COLUMNAR_CHUNK_SAMPLES must be a positive multiple of 128.");
+
+// --- Multi-rate (pyramid) Gaussian parameters ---
+static_assert(MULTIRATE_TOLERANCE > 0.0f && MULTIRATE_TOLERANCE < 1.0f, "MULTIRATE_TOLERANCE must be in range (0, 1).");
+
+// --- Box-filter cascade parameters ---
+static_assert(BOX_CASCADE_PASSES >= 3 && BOX_CASCADE_PASSES <= 5, "BOX_CASCADE_PASSES must be between 3 and 5.");
+
+// --- Accuracy reporting ---
+static_assert(ACCURACY_TOLERANCE > 0.0, "ACCURACY_TOLERANCE must be positive.");
 
 // --- GPU parameters ---
 static_assert(THREADS_PER_GROUP > 0, "THREADS_PER_GROUP must be greater than 0.");
@@ -11,7 +11,10 @@
 
 #include <vector>
 #include <cmath>
+#include <cstdint>
+#include <cstdlib>
 #include <iostream>
+#include <stdexcept>
 
 /**
  * Creates a normalized 1D Gaussian kernel.
@@ -54,4 +57,118 @@ std::vector<float> create_gaussian_kernel(const float sigma) {
     return kernel;
 }
 
+/**
+ * Creates a normalized 1D Gaussian kernel with a radius known only at runtime.
+ * Unlike create_gaussian_kernel, it does not print anything, so it can be used inside processors.
+ *
+ * @param sigma Standard deviation of the Gaussian distribution.
+ * @param radius The half-size of the kernel (Total Size = 2 * radius + 1).
+ * @return A vector of floats containing the normalized kernel weights.
+ * @throws std::runtime_error if sigma is non-positive or radius is negative.
+ */
+inline std::vector<float> create_gaussian_weights(const double sigma, const int radius) {
+    if (sigma <= 0.0 || radius < 0) {
+        throw std::runtime_error("Gaussian weights require positive sigma and non-negative radius");
+    }
+    
+    std::vector<double> weights(2 * radius + 1);
+    double sum = 0.0;
+    
+    const double denominator = 2.0 * sigma * sigma;
+    for (int i = 0; i < (int)weights.size(); ++i) {
+        const double x = i - radius;
+        weights[i] = std::exp(-(x * x) / denominator);
+        sum += weights[i];
+    }
+    
+    std::vector<float> kernel(weights.size());
+    for (size_t i = 0; i < weights.size(); ++i) {
+        kernel[i] = static_cast<float>(weights[i] / sum);
+    }
+    return kernel;
+}
+
+/**
+ * Estimates the standard deviation of a (Gaussian-like) kernel from its second central moment.
+ * Used by approximation modes that work with sigma instead of explicit kernel weights.
+ *
+ * @param convolutionKernel The 1D kernel weights (Size = 2 * Radius + 1).
+ * @return The estimated sigma in samples.
+ * @throws std::runtime_error if the kernel weights do not have a positive sum.
+ */
+inline double estimate_gaussian_sigma(const std::vector<float>& convolutionKernel) {
+    const int radius = static_cast<int>(convolutionKernel.size() / 2);
+    
+    double sum = 0.0;
+    double mean = 0.0;
+    for (int i = 0; i < (int)convolutionKernel.size(); ++i) {
+        sum += convolutionKernel[i];
+        mean += static_cast<double>(i - radius) * convolutionKernel[i];
+    }
+    if (sum <= 0.0) {
+        throw std::runtime_error("Cannot estimate sigma of a kernel with non-positive sum");
+    }
+    mean /= sum;
+    
+    double variance = 0.0;
+    for (int i = 0; i < (int)convolutionKernel.size(); ++i) {
+        const double x = (i - radius) - mean;
+        variance += x * x * convolutionKernel[i];
+    }
+    return std::sqrt(variance / sum);
+}
+
+/**
+ * Kernel quantized to int16 Q-format weights (weight = weights[k] / 2^fracBits).
+ */
+struct QuantizedKernel {
+    std::vector<int16_t> weights;
+    int fracBits;
+    int64_t weightSum;  // Sum of the quantized weights (needed to apply the channel offset).
+};
+
+/**
+ * Quantizes the kernel for fixed-point convolution of int16 samples with int32 accumulation.
+ *
+ * Picks the largest number of fractional bits for which every weight fits into int16 and
+ * no int32 sum of products with int16 samples can overflow (sum |w| * 2^15 < 2^31).
+ * The rounding residue is moved to the center tap, so the quantized kernel keeps the DC gain.
+ *
+ * @param convolutionKernel The 1D kernel weights.
+ * @return QuantizedKernel with the weights and their Q format.
+ * @throws std::runtime_error if the kernel cannot be represented.
+ */
+inline QuantizedKernel quantize_kernel(const std::vector<float>& convolutionKernel) {
+    constexpr int64_t MaxAbsSum = (int64_t(1) << 31) / 32768 - 1;
+    const size_t center = convolutionKernel.size() / 2;
+
+    for (int fracBits = 15; fracBits >= 0; --fracBits) {
+        const double scale = std::ldexp(1.0, fracBits);
+
+        QuantizedKernel result { std::vector<int16_t>(convolutionKernel.size()), fracBits, 0 };
+        double exactSum = 0.0;
+        int64_t absSum = 0;
+        bool fits = true;
+
+        for (size_t k = 0; k < convolutionKernel.size() && fits; ++k) {
+            const long long q = std::llround(convolutionKernel[k] * scale);
+            fits = (q >= -32767 && q <= 32767);
+            result.weights[k] = static_cast<int16_t>(q);
+            result.weightSum += q;
+            exactSum += convolutionKernel[k];
+        }
+        if (!fits) continue;
+
+        const long long center_q = result.weights[center] + (std::llround(exactSum * scale) - result.weightSum);
+        if (center_q < -32767 || center_q > 32767) continue;
+        result.weightSum += center_q - result.weights[center];
+        result.weights[center] = static_cast<int16_t>(center_q);
+
+        for (int16_t w : result.weights) absSum += std::abs(static_cast<int>(w));
+        if (absSum <= MaxAbsSum) return result;
+    }
+
+    throw std::runtime_error("Kernel cannot be quantized to int16 without overflow");
+}
+
 #endif // CONVOLUTION_KERNELS_HPP
@@ -10,17 +10,25 @@
 #define DATA_TYPES_HPP
 
 #include <stdlib.h>
+#include <algorithm>
 #include <new>
 #include <vector>
 #include <string>
 #include <optional>
+#include <memory>
 #include <cstddef>
+#include <cstdint>
+#include <arm_neon.h>
+#include "buffer_pool.hpp"
 
 /**
  * Custom allocator to ensure memory alignment, required for SIMD (Neon) and GPU (Metal) buffers.
+ * Memory comes from the BufferPool, so buffers released by one run are reused by the next one.
  */
 template <typename T, std::size_t Alignment>
 struct aligned_allocator {
+    static_assert(Alignment <= BufferPool::Alignment, "Alignment exceeds the alignment of pooled buffers.");
+
     using value_type = T;
     
     template <class U>
@@ -32,15 +40,11 @@ struct aligned_allocator {
     template <class U> aligned_allocator(const aligned_allocator<U, Alignment>&) noexcept {}
 
     T* allocate(std::size_t n) {
-        void* p;
-        if (posix_memalign(&p, Alignment, n * sizeof(T)) != 0) {
-            throw std::bad_alloc();
-        }
-        return static_cast<T*>(p);
+        return static_cast<T*>(BufferPool::get().acquire(n * sizeof(T)));
     }
 
-    void deallocate(T* p, std::size_t) noexcept {
-        free(p);
+    void deallocate(T* p, std::size_t n) noexcept {
+        BufferPool::get().release(p, n * sizeof(T));
     }
 
     template <class U> bool operator==(const aligned_allocator<U, Alignment>&) const noexcept { return true; }
@@ -50,16 +54,70 @@ struct aligned_allocator {
 // Vector alias using the aligned allocator (16KB alignment).
 using NeonVector = std::vector<float, aligned_allocator<float, 16384>>;
 
+// Vector alias for raw EDF digital samples (same alignment as NeonVector).
+using Int16Vector = std::vector<int16_t, aligned_allocator<int16_t, 16384>>;
+
+// Vector alias for half-precision samples and outputs (same alignment as NeonVector).
+using HalfVector = std::vector<float16_t, aligned_allocator<float16_t, 16384>>;
+
+/**
+ * Per-run scratch array taken from the BufferPool through aligned_allocator. Unlike the vectors above
+ * the elements are left uninitialized, so a reused buffer costs no zero-fill pass; every element has to be
+ * written before it is read.
+ */
+template <typename T>
+class ScratchArray {
+public:
+    explicit ScratchArray(const size_t count) : ptr(allocator.allocate(count)), count(count) {}
+    ~ScratchArray() { allocator.deallocate(ptr, count); }
+
+    ScratchArray(const ScratchArray&) = delete;
+    ScratchArray& operator=(const ScratchArray&) = delete;
+
+    T* data() noexcept { return ptr; }
+    size_t size() const noexcept { return count; }
+
+private:
+    aligned_allocator<T, 16384> allocator;
+    T* ptr;
+    size_t count;
+};
+
+/**
+ * Sample representations kept in memory by the loader.
+ */
+enum class SampleFormat {
+    FLOAT32,            // Physical values (EdfData::samples)
+    INT16,              // Raw digital values (EdfData::digitalSamples), half the memory footprint
+    FLOAT32_AND_INT16,  // Both representations
+    FLOAT16,            // Physical values narrowed to FP16 (EdfData::halfSamples), half the memory footprint
+    ALL,                // Physical, digital and FP16 values (benchmark suite)
+    NONE                // Metadata only, fused modes decode straight from the file's data records
+};
+
+/**
+ * Part of the recording to load: a subset of the channels (by EDF label) and a time window.
+ */
+struct LoadSelection {
+    std::vector<std::string> channels;  // Labels of the channels to load, empty loads all channels.
+    double startSec = 0.0;              // Start of the window (rounded down to a data record).
+    double durationSec = 0.0;           // Length of the window (rounded up to whole records), 0 loads until the end.
+};
+
 /**
  * Structure holding user runtime configuration.
  */
 struct AppConfig {
     std::string filePath;
+    LoadSelection selection;
     bool runAllVariants;
     std::optional<ProcessingMode> mode;
     int iterationCount;
     bool saveResults;
     std::string outputFolderPath;
+    bool recordOutput;  // Quantize the output straight into EDF data records (instead of float).
+    bool followFile;    // Filter a recording that is still being written as its records are appended.
+    std::vector<std::string> batchFiles;  // Files of a batch run (empty for a single file).
 };
 
 /**
@@ -75,6 +133,8 @@ struct EdfChannelParams {
     int dig_min;
     int dig_max;
     int smp_in_datarecord;
+    double scale;   // Linear digital -> physical mapping: physical = digital * scale + offset.
+    double offset;
 };
 
 /**
@@ -85,22 +145,87 @@ struct EdfHeaderInfo {
     std::string recording;
     int startdate_day, startdate_month, startdate_year;
     int starttime_hour, starttime_minute, starttime_second;
+    long long starttime_subsecond; // Fraction of the start second in units of 100 ns (EDF+ / BDF+ only).
     long data_record_duration;
     int num_signals;
 };
 
+/**
+ * Position of the samples within the EDF data records (records follow the header).
+ */
+struct EdfRecordLayout {
+    std::string filePath;
+    size_t headerSize;                  // Bytes before the first loaded data record (the time window may skip records).
+    size_t recordSize;                  // Samples of all signals (annotation signals included) in one data record.
+    size_t bytesPerSample;              // 2 for EDF(+), 3 for BDF(+) (24-bit).
+    long long recordCount;              // Loaded data records.
+    std::vector<size_t> channelOffsets; // First sample of every loaded channel within a record.
+};
+
+struct MappedOutputFile;
+
+/**
+ * Filtered output quantized to the channels' digital ranges, stored in EDF data-record layout
+ * (layout.headerSize is 0, the buffer holds the records only).
+ * The records live in samples, or directly in the data region of a mapped output file.
+ */
+struct EdfRecordOutput {
+    Int16Vector samples;
+    EdfRecordLayout layout;
+    std::shared_ptr<MappedOutputFile> file;  // Mapped output file (nullptr when the records are kept in samples).
+    int16_t* mappedRecords = nullptr;        // First record within the mapping of file.
+
+    int16_t* data() { return mappedRecords ? mappedRecords : samples.data(); }
+    const int16_t* data() const { return mappedRecords ? mappedRecords : samples.data(); }
+    size_t size() const { return static_cast<size_t>(layout.recordCount) * layout.recordSize; }
+};
+
 /**
  * Main container for loaded EDF data, including raw samples and metadata.
+ * Channels are stored back to back, each surrounded by padding samples on both sides.
+ * Channels sampled at different rates have different lengths, so every channel has its own offset.
  */
 struct EdfData {
     NeonVector samples;
+    Int16Vector digitalSamples; // Same layout as samples, only filled for SampleFormat::INT16 / FLOAT32_AND_INT16 / ALL.
+    HalfVector halfSamples;     // Same layout as samples, only filled for SampleFormat::FLOAT16 / ALL.
     EdfHeaderInfo header;
     std::vector<EdfChannelParams> channels;
-    int samplesPerSignal;
-    int samplesPerSignalPadded;
+    EdfRecordLayout records;
+    std::vector<size_t> channelStarts;  // First (padding) sample of every channel in samples / digitalSamples / halfSamples / the output.
+    std::vector<int> channelLengths;    // Samples of every channel, without the border padding.
+    size_t totalSamplesPadded;          // Length of the padded sample arrays (all channels).
     int padding;
+
+    size_t channel_length_padded(const size_t channel) const { return static_cast<size_t>(channelLengths[channel]) + 2 * static_cast<size_t>(padding); }
+};
+
+/**
+ * A contiguous range of output samples within one channel (offsets relative to the channel's start).
+ */
+struct ChannelChunk {
+    int channel;
+    size_t start;
+    size_t count;
 };
 
+/**
+ * Splits the outputs of every channel (length + 2 * padding - (kernelSize - 1) each) into chunks of at most
+ * chunkSize samples. Per-channel parallel modes dispatch over this table instead of over channels, so the work
+ * is balanced by samples even when a few high-rate channels hold most of the data.
+ */
+inline std::vector<ChannelChunk> split_channel_chunks(const EdfData& data, const size_t kernelSize, const size_t chunkSize) {
+    std::vector<ChannelChunk> chunks;
+    for (size_t c = 0; c < data.channelLengths.size(); ++c) {
+        const size_t paddedLength = data.channel_length_padded(c);
+        const size_t outputLength = (paddedLength >= kernelSize) ? paddedLength - kernelSize + 1 : 0;
+        for (size_t start = 0; start < outputLength; start += chunkSize) {
+            chunks.push_back({static_cast<int>(c), start, std::min(chunkSize, outputLength - start)});
+        }
+    }
+    return chunks;
+}
+
 /**
  * Structure for collecting execution timing and memory metrics.
  */
@@ -112,4 +237,13 @@ struct ProcessingStats {
     double gpuMemoryOpsSec;
 };
 
+/**
+ * Structure for collecting the numerical error of a mode against a reference mode.
+ */
+struct AccuracyStats {
+    double maxAbsError;
+    double rmsError;
+    double maxRelError;
+};
+
 #endif // DATA_TYPES_HPP
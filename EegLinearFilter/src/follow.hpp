@@ -0,0 +1,140 @@
+//
+//  follow.hpp
+//  EegLinearFilter
+//
+//  Follow mode: incremental filtering of an EDF recording that is still being written (live acquisition).
+//
+
+#ifndef FOLLOW_HPP
+#define FOLLOW_HPP
+
+#include "config.h"
+#include "io/io.hpp"
+#include "io/edf_reader.hpp"
+#include "io/file_watch.hpp"
+#include "processors/processors.hpp"
+#include "../lib/magic_enum/magic_enum.hpp"
+#include <dispatch/dispatch.h>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * Builds the input of one follow step in the loader layout: data records [firstRecord, end of file) of every
+ * channel, surrounded by padding. Records before firstRecord are already filtered, firstRecord starts the
+ * unconsumed history (at least kernel size - 1 samples of every channel).
+ *
+ * @param reader Reader of the growing recording.
+ * @param firstRecord First record of the window.
+ * @param padding Border padding of every channel (kernel radius).
+ * @param format Sample representation(s) the processing mode needs.
+ */
+inline EdfData read_follow_window(const EdfReader& reader, const long long firstRecord, const int padding, const SampleFormat format) {
+    const EdfData& source = reader.metadata();
+
+    EdfData window;
+    window.header = source.header;
+    window.channels = source.channels;
+    window.padding = padding;
+    // Same record range as a time window of the loader (fused modes decode straight from the file).
+    window.records = source.records;
+    window.records.headerSize += static_cast<size_t>(firstRecord) * source.records.recordSize * source.records.bytesPerSample;
+    window.records.recordCount = source.records.recordCount - firstRecord;
+
+    window.totalSamplesPadded = 0;
+    for (const auto& ch : window.channels) {
+        window.channelStarts.push_back(window.totalSamplesPadded);
+        window.channelLengths.push_back(static_cast<int>(window.records.recordCount * ch.smp_in_datarecord));
+        window.totalSamplesPadded += window.channel_length_padded(window.channelLengths.size() - 1);
+    }
+
+    const bool half = (format == SampleFormat::FLOAT16 || format == SampleFormat::ALL);
+    const bool physical = half || format == SampleFormat::FLOAT32 || format == SampleFormat::FLOAT32_AND_INT16;
+    const bool digital = (format == SampleFormat::INT16 || format == SampleFormat::FLOAT32_AND_INT16 || format == SampleFormat::ALL);
+    if (physical) window.samples.resize(window.totalSamplesPadded);
+    if (digital) window.digitalSamples.resize(window.totalSamplesPadded);
+
+    const EdfReader* readerPtr = &reader;
+    EdfData* windowPtr = &window;
+
+    dispatch_apply(window.channels.size(), dispatch_get_global_queue(QOS_CLASS_USER_INTERACTIVE, 0), ^(size_t c) {
+        const size_t start = static_cast<size_t>(firstRecord) * windowPtr->channels[c].smp_in_datarecord;
+        const size_t count = static_cast<size_t>(windowPtr->channelLengths[c]);
+        const std::vector<int> channel = {static_cast<int>(c)};
+
+        if (physical) readerPtr->read(channel, start, count, windowPtr->samples.data() + windowPtr->channelStarts[c], padding);
+        if (digital) readerPtr->read_digital(channel, start, count, windowPtr->digitalSamples.data() + windowPtr->channelStarts[c], padding);
+    });
+
+    // FP16 samples are narrowed from the physical values (as by the loader).
+    if (half) narrow_half_samples(window, format == SampleFormat::ALL);
+    return window;
+}
+
+/**
+ * Follows an EDF recording that another process keeps appending data records to.
+ * Every step filters only the records appended since the previous step, together with the unconsumed history
+ * (the last kernel size - 1 samples of every channel, rounded to whole records), and appends the finished output
+ * records to the output EDF. The output equals a single run over the whole recording.
+ * Ends when the recording has not grown for FOLLOW_IDLE_TIMEOUT_SEC.
+ *
+ * @param mode Processing mode applied to every step.
+ * @param inputFilename Path to the growing .edf file.
+ * @param convolutionKernel The filter kernel.
+ * @param outputFolderPath Directory path where the output file is written.
+ */
+void run_follow(const ProcessingMode mode, const std::string& inputFilename, const std::vector<float>& convolutionKernel, const std::string& outputFolderPath) {
+    std::cout << "Mode: " << magic_enum::enum_name(mode) << " (following " << inputFilename << ")" << std::endl;
+    std::cout << "----------------------------------------\n";
+
+    EdfReader reader(inputFilename, true);
+    if (reader.metadata().records.bytesPerSample != sizeof(int16_t)) {
+        throw std::runtime_error("Follow mode supports 16-bit EDF recordings only");
+    }
+
+    const std::string outputFilename = outputFolderPath + std::string(magic_enum::enum_name(mode)) + ".edf";
+    create_growing_edf(outputFilename, reader.metadata());
+
+    const FileWatch watch(inputFilename);
+    const SampleFormat format = required_sample_format(mode);
+
+    long long processedRecords = 0;  // Input records whose outputs are all written (the history starts here).
+    long long outputRecords = 0;
+    double filterTimeSec = 0.0;
+    int steps = 0;
+    bool grown = reader.metadata().records.recordCount > 0;
+    auto lastGrowth = std::chrono::steady_clock::now();
+
+    while (true) {
+        if (grown) {
+            const EdfData window = read_follow_window(reader, processedRecords, KERNEL_RADIUS, format);
+            EdfRecordOutput records = create_record_output(window, convolutionKernel.size());
+
+            if (records.layout.recordCount > 0) {
+                NeonVector outputBuffer(supports_fused_record_output(mode) ? 0 : window.totalSamplesPadded);
+                const ProcessingStats stats = run_processor<KERNEL_RADIUS, CHUNK_SIZE, K_BATCH>(mode, window, outputBuffer, convolutionKernel, &records);
+                outputRecords = append_edf_records(records, outputFilename);
+                processedRecords += records.layout.recordCount;
+                filterTimeSec += stats.totalTimeSec;
+                ++steps;
+
+                std::cout << "Step " << steps << ": +" << records.layout.recordCount << " records (output " << outputRecords
+                          << ", input " << reader.metadata().records.recordCount << ") in " << stats.totalTimeSec << "s" << std::endl;
+            }
+        }
+
+        if (std::chrono::steady_clock::now() - lastGrowth > std::chrono::seconds(FOLLOW_IDLE_TIMEOUT_SEC)) break;
+
+        watch.wait(FOLLOW_POLL_INTERVAL_MS);
+        grown = reader.refresh() > 0;
+        if (grown) lastGrowth = std::chrono::steady_clock::now();
+    }
+
+    std::cout << "Recording idle for " << FOLLOW_IDLE_TIMEOUT_SEC << "s, follow mode finished." << std::endl;
+    std::cout << "Steps: " << steps << " | Output records: " << outputRecords << " | Filtering: " << filterTimeSec << "s"
+              << " | File events: " << (watch.has_events() ? "yes" : "no (interval polling)") << std::endl;
+    std::cout << "Output: " << outputFilename << std::endl;
+}
+
+#endif // FOLLOW_HPP
@@ -0,0 +1,58 @@
+//
+//  half_precision.hpp
+//  EegLinearFilter
+//
+//  Neon helpers converting ranges of samples between FP32 and half precision (FP16).
+//
+
+#ifndef HALF_PRECISION_HPP
+#define HALF_PRECISION_HPP
+
+#include <arm_neon.h>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+// Largest finite FP16 value.
+constexpr float FP16_MAX = 65504.0f;
+
+/**
+ * Narrows a range of samples to FP16.
+ *
+ * @return Max. absolute value of the range (to detect overflow).
+ */
+inline float fp16_narrow_range(const float* __restrict src, float16_t* __restrict dst, const size_t count) {
+    float32x4_t maxAbs = vdupq_n_f32(0.0f);
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        const float32x4_t a = vld1q_f32(src + i);
+        const float32x4_t b = vld1q_f32(src + i + 4);
+        maxAbs = vmaxq_f32(maxAbs, vmaxq_f32(vabsq_f32(a), vabsq_f32(b)));
+        vst1q_f16(dst + i, vcvt_high_f16_f32(vcvt_f16_f32(a), b));
+    }
+
+    float result = vmaxvq_f32(maxAbs);
+    for (; i < count; ++i) {
+        result = std::max(result, std::abs(src[i]));
+        dst[i] = static_cast<float16_t>(src[i]);
+    }
+    return result;
+}
+
+/**
+ * Widens a range of FP16 values back to FP32.
+ */
+inline void fp16_widen_range(const float16_t* __restrict src, float* __restrict dst, const size_t count) {
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        const float16x8_t h = vld1q_f16(src + i);
+        vst1q_f32(dst + i, vcvt_f32_f16(vget_low_f16(h)));
+        vst1q_f32(dst + i + 4, vcvt_high_f32_f16(h));
+    }
+
+    for (; i < count; ++i) dst[i] = static_cast<float>(src[i]);
+}
+
+#endif // HALF_PRECISION_HPP
@@ -0,0 +1,213 @@
+//
+//  async_io.hpp
+//  EegLinearFilter
+//
+//  Asynchronous block I/O: positioned reads and writes kept in flight on GCD workers while the caller decodes.
+//
+
+#ifndef ASYNC_IO_HPP
+#define ASYNC_IO_HPP
+
+#include "../config.h"
+#include "../data_types.hpp"
+#include <dispatch/dispatch.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <stdexcept>
+#include <vector>
+
+// Byte buffer for block I/O (page aligned, as direct I/O requires).
+using IoBuffer = std::vector<uint8_t, aligned_allocator<uint8_t, 16384>>;
+
+// Offsets and sizes of direct (uncached) reads are rounded to this boundary.
+constexpr size_t DirectIoAlignment = 4096;
+
+// RAII wrapper for a file descriptor used by positioned reads / writes.
+struct FileDescriptorGuard {
+    int fd;
+
+    explicit FileDescriptorGuard(const int f) : fd(f) {}
+
+    ~FileDescriptorGuard() {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    FileDescriptorGuard(const FileDescriptorGuard&) = delete;
+    FileDescriptorGuard& operator=(const FileDescriptorGuard&) = delete;
+};
+
+/**
+ * Opens a file for positioned reads. With direct set, the reads bypass the page cache (O_DIRECT on Linux,
+ * F_NOCACHE on macOS), so repeated benchmarks measure the device instead of the cache.
+ * Falls back to cached reads when the file system does not support direct I/O.
+ *
+ * @return File descriptor, or -1 if the file cannot be opened.
+ */
+inline int open_for_reading(const char* filePath, const bool direct) {
+#ifdef O_DIRECT
+    if (direct) {
+        const int fd = open(filePath, O_RDONLY | O_DIRECT);
+        if (fd >= 0) return fd;
+    }
+    return open(filePath, O_RDONLY);
+#else
+    const int fd = open(filePath, O_RDONLY);
+#ifdef F_NOCACHE
+    if (fd >= 0 && direct) fcntl(fd, F_NOCACHE, 1);
+#endif
+    return fd;
+#endif
+}
+
+// Helper to read at least minSize (at most size) bytes at offset, stopping early at the end of the file.
+inline size_t read_at_least(const int fd, uint8_t* dst, size_t size, const size_t minSize, off_t offset) {
+    size_t total = 0;
+    while (total < size) {
+        const ssize_t n = pread(fd, dst + total, size - total, offset);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) throw std::runtime_error("Reading data records failed");
+        if (n == 0) break;
+
+        total += static_cast<size_t>(n);
+        offset += n;
+    }
+    if (total < minSize) throw std::runtime_error("Unexpected end of data records");
+    return total;
+}
+
+// Helper to read exactly size bytes at offset (pread may return fewer bytes than requested).
+inline void read_at(const int fd, uint8_t* dst, const size_t size, const off_t offset) {
+    read_at_least(fd, dst, size, size, offset);
+}
+
+// Helper to write exactly size bytes at offset (pwrite may write fewer bytes than requested).
+inline void write_at(const int fd, const uint8_t* src, size_t size, off_t offset) {
+    while (size > 0) {
+        const ssize_t n = pwrite(fd, src, size, offset);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) throw std::runtime_error("Writing data records failed");
+
+        src += n;
+        size -= static_cast<size_t>(n);
+        offset += n;
+    }
+}
+
+/**
+ * Reads blockCount blocks with up to IO_QUEUE_DEPTH blocks in flight.
+ * Every block in flight owns one buffer of a fixed ring (allocated once, reused for every block):
+ * fill(block, buffer) issues the reads of a block on a GCD worker, consume(block, buffer) runs on the
+ * calling thread in block order as soon as the block has arrived, while the following blocks are still being read.
+ * The first error (of a fill or a consume) stops further reads and is rethrown once the reads in flight have finished.
+ *
+ * @return Seconds the calling thread spent waiting for reads (I/O not hidden behind consume).
+ */
+template <typename Fill, typename Consume>
+double pipelined_read(const size_t blockCount, const size_t bufferBytes, const Fill& fill, const Consume& consume) {
+    const size_t depth = std::min(static_cast<size_t>(IO_QUEUE_DEPTH), blockCount);
+    if (depth == 0) return 0.0;
+
+    std::vector<IoBuffer> buffers(depth);
+    std::vector<std::exception_ptr> errors(depth);
+    std::vector<dispatch_semaphore_t> done(depth);
+    for (size_t i = 0; i < depth; ++i) {
+        buffers[i].resize(bufferBytes);
+        done[i] = dispatch_semaphore_create(0);
+    }
+
+    dispatch_queue_t queue = dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0);
+    const Fill* fillPtr = &fill;
+    size_t submitted = 0;
+
+    auto submit = [&]() {
+        const size_t block = submitted++;
+        const size_t slot = block % depth;
+        uint8_t* buffer = buffers[slot].data();
+        std::exception_ptr* error = &errors[slot];
+        dispatch_semaphore_t signal = done[slot];
+
+        dispatch_async(queue, ^{
+            try {
+                (*fillPtr)(block, buffer);
+            } catch (...) {
+                *error = std::current_exception();
+            }
+            dispatch_semaphore_signal(signal);
+        });
+    };
+
+    while (submitted < depth) submit();
+
+    std::exception_ptr failure;
+    double waitSec = 0.0;
+    for (size_t block = 0; block < submitted; ++block) {
+        const size_t slot = block % depth;
+        const auto waitStart = std::chrono::high_resolution_clock::now();
+        dispatch_semaphore_wait(done[slot], DISPATCH_TIME_FOREVER);
+        waitSec += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - waitStart).count();
+
+        if (!failure) failure = errors[slot];
+        if (failure) continue;
+
+        try {
+            consume(block, buffers[slot].data());
+        } catch (...) {
+            failure = std::current_exception();
+            continue;
+        }
+        if (submitted < blockCount) submit();
+    }
+
+    for (dispatch_semaphore_t semaphore : done) dispatch_release(semaphore);
+    if (failure) std::rethrow_exception(failure);
+    return waitSec;
+}
+
+/**
+ * Writes size bytes at offset in blocks of IO_BLOCK_BYTES with up to IO_QUEUE_DEPTH writes in flight
+ * (disjoint ranges, so the blocks may complete in any order).
+ *
+ * @throws std::runtime_error if a write fails (after the writes in flight have finished).
+ */
+inline void pipelined_write(const int fd, const uint8_t* data, const size_t size, const off_t offset) {
+    const size_t blockCount = (size + IO_BLOCK_BYTES - 1) / IO_BLOCK_BYTES;
+    std::vector<std::exception_ptr> errors(blockCount);
+    dispatch_semaphore_t slots = dispatch_semaphore_create(IO_QUEUE_DEPTH);
+    dispatch_queue_t queue = dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0);
+
+    for (size_t block = 0; block < blockCount; ++block) {
+        dispatch_semaphore_wait(slots, DISPATCH_TIME_FOREVER);
+
+        const size_t start = block * IO_BLOCK_BYTES;
+        const size_t bytes = std::min(static_cast<size_t>(IO_BLOCK_BYTES), size - start);
+        std::exception_ptr* error = &errors[block];
+
+        dispatch_async(queue, ^{
+            try {
+                write_at(fd, data + start, bytes, offset + static_cast<off_t>(start));
+            } catch (...) {
+                *error = std::current_exception();
+            }
+            dispatch_semaphore_signal(slots);
+        });
+    }
+
+    // Taking every slot back waits for the writes still in flight.
+    // GCD requires the initial value to be restored before the semaphore is released.
+    for (int i = 0; i < IO_QUEUE_DEPTH; ++i) dispatch_semaphore_wait(slots, DISPATCH_TIME_FOREVER);
+    for (int i = 0; i < IO_QUEUE_DEPTH; ++i) dispatch_semaphore_signal(slots);
+    dispatch_release(slots);
+
+    for (const std::exception_ptr& error : errors) {
+        if (error) std::rethrow_exception(error);
+    }
+}
+
+#endif // ASYNC_IO_HPP
@@ -0,0 +1,255 @@
+//
+//  columnar_format.hpp
+//  EegLinearFilter
+//
+//  Compressed chunked columnar output format: file layout and the Neon chunk codec (residuals + 4-lane bit-packing).
+//
+
+#ifndef COLUMNAR_FORMAT_HPP
+#define COLUMNAR_FORMAT_HPP
+
+#include <arm_neon.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/*
+ * File layout (little-endian):
+ *   ColumnarFileHeader
+ *   ColumnarChannelHeader[channelCount]
+ *   chunks (every channel split into chunks of chunkSamples samples, each decodable on its own)
+ *   ColumnarChunkEntry[chunkCount] (chunk index, channel by channel, at header.indexOffset)
+ *
+ * Chunk layout:
+ *   uint32 first value
+ *   uint8 bit width of every block of ColumnarBlockSamples residuals (padded to 4 bytes)
+ *   packed blocks: 4 * width uint32 words each, value i of a block in lane i % 4
+ */
+
+constexpr char ColumnarMagic[8] = {'E', 'E', 'G', 'C', 'O', 'L', '1', '\0'};
+constexpr uint32_t ColumnarVersion = 1;
+constexpr size_t ColumnarBlockSamples = 128;
+
+/**
+ * Stored sample representation and the residual predicting every sample from its predecessor.
+ */
+enum class ColumnarSampleType : uint32_t {
+    FLOAT32_XOR = 0,    // Physical float32 output, residual = bits XOR previous bits (bit-exact)
+    DIGITAL_DELTA = 1   // Output quantized to the channel's digital range (as in EDF), residual = zigzag(sample - previous)
+};
+
+struct ColumnarFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t sampleType;    // ColumnarSampleType
+    uint32_t channelCount;
+    uint32_t chunkSamples;
+    uint64_t indexOffset;   // Chunk index, written after the chunks.
+    uint64_t chunkCount;
+    char patient[80];
+    char recording[80];
+    char startDate[8];      // dd.mm.yy (as in the EDF header)
+    char startTime[8];      // hh.mm.ss
+};
+
+struct ColumnarChannelHeader {
+    char label[16];
+    char dimension[8];
+    double sampleRate;
+    double physMin;
+    double physMax;
+    int32_t digMin;
+    int32_t digMax;
+    uint64_t sampleCount;
+    uint64_t firstChunk;    // Index entry of the channel's first chunk.
+};
+
+struct ColumnarChunkEntry {
+    uint64_t offset;
+    uint32_t bytes;
+    uint32_t samples;
+};
+
+static_assert(sizeof(ColumnarFileHeader) == 216, "Unexpected padding in ColumnarFileHeader.");
+static_assert(sizeof(ColumnarChannelHeader) == 72, "Unexpected padding in ColumnarChannelHeader.");
+static_assert(sizeof(ColumnarChunkEntry) == 16, "Unexpected padding in ColumnarChunkEntry.");
+
+// Offset of the first packed block within a chunk (first value + width bytes, 4-byte aligned).
+inline size_t columnar_blocks_offset(const size_t blockCount) {
+    return sizeof(uint32_t) + (blockCount + 3) / 4 * 4;
+}
+
+// Upper bound of the encoded size of a chunk with count samples (every block at full width).
+inline size_t columnar_chunk_bound(const size_t count) {
+    const size_t blockCount = (count + ColumnarBlockSamples - 1) / ColumnarBlockSamples;
+    return columnar_blocks_offset(blockCount) + blockCount * ColumnarBlockSamples * sizeof(uint32_t);
+}
+
+/**
+ * Packs 128 values of at most width bits into 4 * width words.
+ * Every lane packs its 32 values (i % 4 == lane) on its own, so the whole block needs only vector shifts.
+ */
+inline void pack_block(const uint32_t* in, uint32_t* out, const int width) {
+    if (width == 0) return;
+    if (width == 32) {
+        std::memcpy(out, in, ColumnarBlockSamples * sizeof(uint32_t));
+        return;
+    }
+
+    uint32x4_t word = vdupq_n_u32(0);
+    int filled = 0;
+    for (size_t j = 0; j < ColumnarBlockSamples / 4; ++j) {
+        const uint32x4_t v = vld1q_u32(in + 4 * j);
+        word = vorrq_u32(word, vshlq_u32(v, vdupq_n_s32(filled)));
+        filled += width;
+
+        if (filled >= 32) {
+            vst1q_u32(out, word);
+            out += 4;
+            filled -= 32;
+            // The bits of v that did not fit start the next word (negative shift = right shift).
+            word = (filled > 0) ? vshlq_u32(v, vdupq_n_s32(filled - width)) : vdupq_n_u32(0);
+        }
+    }
+}
+
+/**
+ * Unpacks 128 values of width bits packed by pack_block.
+ */
+inline void unpack_block(const uint32_t* in, uint32_t* out, const int width) {
+    if (width == 0) {
+        std::fill_n(out, ColumnarBlockSamples, 0u);
+        return;
+    }
+    if (width == 32) {
+        std::memcpy(out, in, ColumnarBlockSamples * sizeof(uint32_t));
+        return;
+    }
+
+    const uint32x4_t mask = vdupq_n_u32((1u << width) - 1);
+    uint32x4_t word = vld1q_u32(in);
+    int used = 0;
+    for (size_t j = 0; j < ColumnarBlockSamples / 4; ++j) {
+        uint32x4_t v = vshlq_u32(word, vdupq_n_s32(-used));
+        used += width;
+
+        if (used > 32) {
+            // The value continues in the next word.
+            in += 4;
+            word = vld1q_u32(in);
+            v = vorrq_u32(v, vshlq_u32(word, vdupq_n_s32(32 - (used - width))));
+            used -= 32;
+        } else if (used == 32 && j + 1 < ColumnarBlockSamples / 4) {
+            in += 4;
+            word = vld1q_u32(in);
+            used = 0;
+        }
+        vst1q_u32(out + 4 * j, vandq_u32(v, mask));
+    }
+}
+
+/**
+ * Encodes count values (float32 bits or digital samples as int32) into one chunk.
+ * Residuals are computed four at a time against the previous values, every block stores the bit width of
+ * its largest residual. A partial last block repeats the last value (zero residuals).
+ *
+ * @param dst Output, must hold columnar_chunk_bound(count) bytes (4-byte aligned).
+ * @return Encoded size in bytes.
+ */
+inline size_t encode_columnar_chunk(const uint32_t* values, const size_t count, const ColumnarSampleType type, uint8_t* dst) {
+    const size_t blockCount = (count + ColumnarBlockSamples - 1) / ColumnarBlockSamples;
+    std::memcpy(dst, values, sizeof(uint32_t));
+    uint8_t* widths = dst + sizeof(uint32_t);
+    std::fill(widths, dst + columnar_blocks_offset(blockCount), 0);
+    uint32_t* packed = reinterpret_cast<uint32_t*>(dst + columnar_blocks_offset(blockCount));
+
+    alignas(16) uint32_t block[ColumnarBlockSamples];
+    alignas(16) uint32_t residuals[ColumnarBlockSamples];
+    uint32x4_t previous = vdupq_n_u32(values[0]);
+
+    for (size_t b = 0; b < blockCount; ++b) {
+        const size_t start = b * ColumnarBlockSamples;
+        const size_t n = std::min(ColumnarBlockSamples, count - start);
+        std::memcpy(block, values + start, n * sizeof(uint32_t));
+        std::fill(block + n, block + ColumnarBlockSamples, values[count - 1]);
+
+        uint32x4_t bits = vdupq_n_u32(0);
+        for (size_t i = 0; i < ColumnarBlockSamples; i += 4) {
+            const uint32x4_t current = vld1q_u32(block + i);
+            const uint32x4_t shifted = vextq_u32(previous, current, 3);  // values i - 1 .. i + 2
+            uint32x4_t r;
+            if (type == ColumnarSampleType::FLOAT32_XOR) {
+                r = veorq_u32(current, shifted);
+            } else {
+                const int32x4_t delta = vsubq_s32(vreinterpretq_s32_u32(current), vreinterpretq_s32_u32(shifted));
+                r = veorq_u32(vreinterpretq_u32_s32(vshlq_n_s32(delta, 1)), vreinterpretq_u32_s32(vshrq_n_s32(delta, 31)));
+            }
+            vst1q_u32(residuals + i, r);
+            bits = vorrq_u32(bits, r);
+            previous = current;
+        }
+
+        const uint32_t maxBits = vmaxvq_u32(bits);
+        const int width = maxBits ? 32 - __builtin_clz(maxBits) : 0;
+        widths[b] = static_cast<uint8_t>(width);
+        pack_block(residuals, packed, width);
+        packed += 4 * width;
+    }
+
+    return reinterpret_cast<uint8_t*>(packed) - dst;
+}
+
+/**
+ * Decodes a chunk of count values encoded by encode_columnar_chunk.
+ *
+ * @param values Output, must hold count rounded up to a multiple of ColumnarBlockSamples values.
+ */
+inline void decode_columnar_chunk(const uint8_t* src, const size_t count, const ColumnarSampleType type, uint32_t* values) {
+    const size_t blockCount = (count + ColumnarBlockSamples - 1) / ColumnarBlockSamples;
+    uint32_t previous;
+    std::memcpy(&previous, src, sizeof(uint32_t));
+    const uint8_t* widths = src + sizeof(uint32_t);
+    const uint32_t* packed = reinterpret_cast<const uint32_t*>(src + columnar_blocks_offset(blockCount));
+
+    for (size_t b = 0; b < blockCount; ++b) {
+        uint32_t* out = values + b * ColumnarBlockSamples;
+        unpack_block(packed, out, widths[b]);
+        packed += 4 * widths[b];
+
+        // Prefix over the residuals (sequential by nature).
+        for (size_t i = 0; i < ColumnarBlockSamples; ++i) {
+            if (type == ColumnarSampleType::FLOAT32_XOR) {
+                previous ^= out[i];
+            } else {
+                previous += (out[i] >> 1) ^ (0u - (out[i] & 1u));
+            }
+            out[i] = previous;
+        }
+    }
+}
+
+/**
+ * Physical value of a stored sample: the float32 bits, or the digital value scaled by the channel's ranges.
+ */
+struct ColumnarScaling {
+    ColumnarSampleType type;
+    float scale = 1.0f;
+    float offset = 0.0f;
+
+    ColumnarScaling(const ColumnarSampleType type, const ColumnarChannelHeader& channel) : type(type) {
+        const double digRange = channel.digMax - channel.digMin;
+        if (digRange == 0) return;
+        scale = static_cast<float>((channel.physMax - channel.physMin) / digRange);
+        offset = static_cast<float>(channel.physMin - channel.digMin * scale);
+    }
+
+    float physical(const uint32_t value) const {
+        if (type == ColumnarSampleType::DIGITAL_DELTA) return static_cast<float>(static_cast<int32_t>(value)) * scale + offset;
+        float sample;
+        std::memcpy(&sample, &value, sizeof(float));
+        return sample;
+    }
+};
+
+#endif // COLUMNAR_FORMAT_HPP
@@ -0,0 +1,332 @@
+//
+//  columnar_output.cpp
+//  EegLinearFilter
+//
+//  Export of filtered signals to the compressed chunked columnar format and random-access reading of it.
+//
+
+#include "io.hpp"
+#include "edf_records.hpp"
+#include "async_io.hpp"
+#include "columnar_format.hpp"
+#include <dispatch/dispatch.h>
+#include <iostream>
+#include <iomanip>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+
+// Helper to copy a string into a space-padded fixed-width header field (as in the EDF header).
+void copy_columnar_field(char* field, const std::string& value, const size_t width) {
+    std::memset(field, ' ', width);
+    std::memcpy(field, value.data(), std::min(value.size(), width));
+}
+
+/**
+ * Reads back one window per channel through read_columnar_samples and compares it with the samples that were
+ * encoded. The window is one chunk long and centered in the channel, so it crosses a chunk boundary
+ * whenever the channel has more than one chunk.
+ *
+ * @throws std::runtime_error if a read-back sample differs from the written one.
+ */
+template <typename Fetch>
+void verify_columnar_readback(const std::string& filepath, const std::vector<ColumnarChannelHeader>& channelHeaders,
+                              const ColumnarSampleType type, const Fetch& fetch) {
+    for (size_t c = 0; c < channelHeaders.size(); ++c) {
+        const size_t sampleCount = channelHeaders[c].sampleCount;
+        const size_t count = std::min<size_t>(COLUMNAR_CHUNK_SAMPLES, sampleCount);
+        const size_t first = (sampleCount - count) / 2;
+
+        std::vector<uint32_t> written(count);
+        if (count > 0) fetch(static_cast<int>(c), first, count, written.data());
+        const std::vector<float> readBack = read_columnar_samples(filepath, static_cast<int>(c), first, count);
+
+        const ColumnarScaling scaling(type, channelHeaders[c]);
+        for (size_t i = 0; i < count; ++i) {
+            const float expected = scaling.physical(written[i]);
+            // Compared bitwise, so a NaN of the lossless output matches itself.
+            if (std::memcmp(&readBack[i], &expected, sizeof(float)) != 0) {
+                throw std::runtime_error("Error: Columnar read-back differs from the written samples (channel " + std::to_string(c) + "): " + filepath);
+            }
+        }
+    }
+}
+
+/**
+ * Encodes all chunks in parallel (one GCD task per chunk) and writes the file: headers, chunks, chunk index.
+ *
+ * @param sampleCounts Samples written per channel.
+ * @param fetch fetch(channel, firstSample, count, dst) copies the raw 32-bit values of a chunk to dst.
+ */
+template <typename Fetch>
+void write_columnar_file(const std::string& filepath, const EdfData& sourceData, const std::vector<size_t>& sampleCounts,
+                         const ColumnarSampleType type, const Fetch& fetch) {
+    std::filesystem::path pathObj(filepath);
+    std::filesystem::path dirPath = pathObj.parent_path();
+    if (!dirPath.empty() && !std::filesystem::exists(dirPath)) {
+        std::filesystem::create_directories(dirPath);
+    }
+
+    const int channelCount = sourceData.header.num_signals;
+    if (channelCount < 1) {
+        throw std::runtime_error("Error: No channels to save.");
+    }
+
+    const auto& hdr = sourceData.header;
+    const double recordSec = hdr.data_record_duration / 10000000.0;
+
+    ColumnarFileHeader fileHeader = {};
+    std::memcpy(fileHeader.magic, ColumnarMagic, sizeof(fileHeader.magic));
+    fileHeader.version = ColumnarVersion;
+    fileHeader.sampleType = static_cast<uint32_t>(type);
+    fileHeader.channelCount = static_cast<uint32_t>(channelCount);
+    fileHeader.chunkSamples = COLUMNAR_CHUNK_SAMPLES;
+
+    char field[16];
+    copy_columnar_field(fileHeader.patient, hdr.patient, sizeof(fileHeader.patient));
+    copy_columnar_field(fileHeader.recording, hdr.recording, sizeof(fileHeader.recording));
+    snprintf(field, sizeof(field), "%02d.%02d.%02d", hdr.startdate_day, hdr.startdate_month, hdr.startdate_year % 100);
+    copy_columnar_field(fileHeader.startDate, field, sizeof(fileHeader.startDate));
+    snprintf(field, sizeof(field), "%02d.%02d.%02d", hdr.starttime_hour, hdr.starttime_minute, hdr.starttime_second);
+    copy_columnar_field(fileHeader.startTime, field, sizeof(fileHeader.startTime));
+
+    // Every channel is split into chunks of COLUMNAR_CHUNK_SAMPLES samples.
+    std::vector<ColumnarChannelHeader> channelHeaders(channelCount);
+    std::vector<ChannelChunk> chunks;
+    for (int c = 0; c < channelCount; ++c) {
+        const auto& ch = sourceData.channels[c];
+        ColumnarChannelHeader& channelHeader = channelHeaders[c];
+        copy_columnar_field(channelHeader.label, ch.label, sizeof(channelHeader.label));
+        copy_columnar_field(channelHeader.dimension, ch.dimension, sizeof(channelHeader.dimension));
+        channelHeader.sampleRate = ch.smp_in_datarecord / recordSec;
+        channelHeader.physMin = ch.phys_min;
+        channelHeader.physMax = ch.phys_max;
+        channelHeader.digMin = ch.dig_min;
+        channelHeader.digMax = ch.dig_max;
+        channelHeader.sampleCount = sampleCounts[c];
+        channelHeader.firstChunk = chunks.size();
+
+        for (size_t start = 0; start < sampleCounts[c]; start += COLUMNAR_CHUNK_SAMPLES) {
+            chunks.push_back({c, start, std::min(static_cast<size_t>(COLUMNAR_CHUNK_SAMPLES), sampleCounts[c] - start)});
+        }
+    }
+
+    std::vector<IoBuffer> encoded(chunks.size());
+    std::vector<ColumnarChunkEntry> index(chunks.size());
+
+    const ChannelChunk* chunksPtr = chunks.data();
+    IoBuffer* encodedPtr = encoded.data();
+    ColumnarChunkEntry* indexPtr = index.data();
+    const Fetch* fetchPtr = &fetch;
+
+    dispatch_apply(chunks.size(), dispatch_get_global_queue(QOS_CLASS_USER_INTERACTIVE, 0), ^(size_t i) {
+        const ChannelChunk& chunk = chunksPtr[i];
+        std::vector<uint32_t> values(chunk.count);
+        (*fetchPtr)(chunk.channel, chunk.start, chunk.count, values.data());
+
+        encodedPtr[i].resize(columnar_chunk_bound(chunk.count));
+        indexPtr[i].bytes = static_cast<uint32_t>(encode_columnar_chunk(values.data(), chunk.count, type, encodedPtr[i].data()));
+        indexPtr[i].samples = static_cast<uint32_t>(chunk.count);
+    });
+
+    uint64_t offset = sizeof(ColumnarFileHeader) + channelHeaders.size() * sizeof(ColumnarChannelHeader);
+    for (ColumnarChunkEntry& entry : index) {
+        entry.offset = offset;
+        offset += entry.bytes;
+    }
+    fileHeader.indexOffset = offset;
+    fileHeader.chunkCount = index.size();
+
+    FileDescriptorGuard file(open(filepath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644));
+    if (file.fd < 0) {
+        throw std::runtime_error("Error: Could not open file for writing: " + filepath);
+    }
+
+    // Chunks have known offsets, so they are written in parallel.
+    std::atomic<bool> failed{false};
+    std::atomic<bool>* failedPtr = &failed;
+    const int fd = file.fd;
+    dispatch_apply(index.size(), dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t i) {
+        try {
+            write_at(fd, encodedPtr[i].data(), indexPtr[i].bytes, static_cast<off_t>(indexPtr[i].offset));
+        } catch (const std::runtime_error&) {
+            failedPtr->store(true);
+        }
+    });
+
+    try {
+        if (failed) throw std::runtime_error("Writing chunks failed");
+        write_at(fd, reinterpret_cast<const uint8_t*>(index.data()), index.size() * sizeof(ColumnarChunkEntry), static_cast<off_t>(fileHeader.indexOffset));
+        write_at(fd, reinterpret_cast<const uint8_t*>(channelHeaders.data()), channelHeaders.size() * sizeof(ColumnarChannelHeader), sizeof(ColumnarFileHeader));
+        write_at(fd, reinterpret_cast<const uint8_t*>(&fileHeader), sizeof(fileHeader), 0);
+    } catch (const std::runtime_error&) {
+        throw std::runtime_error("Error: Writing columnar output failed: " + filepath);
+    }
+
+    verify_columnar_readback(filepath, channelHeaders, type, fetch);
+
+    size_t edfBytes = 256 * (channelCount + 1);
+    for (size_t count : sampleCounts) edfBytes += count * sourceData.records.bytesPerSample;
+    const uint64_t fileBytes = offset + index.size() * sizeof(ColumnarChunkEntry);
+    std::cout << "Columnar size: " << std::fixed << std::setprecision(1) << (fileBytes / 1024.0 / 1024.0) << " MB in " << index.size()
+              << " chunks (EDF " << (edfBytes / 1024.0 / 1024.0) << " MB, " << std::setprecision(2)
+              << (static_cast<double>(edfBytes) / fileBytes) << "x)" << std::defaultfloat << std::endl;
+}
+
+/**
+ * Saves the filtered float output in the columnar format. Every channel is split into chunks that are encoded
+ * in parallel: the output is quantized to the channel's digital range like the EDF export (zigzag deltas), or with
+ * COLUMNAR_LOSSLESS_FLOAT kept bit-exact (XOR of consecutive float32 values). Both are bit-packed with Neon.
+ * Writes the same samples as save_data (whole records of valid, non-border outputs).
+ *
+ * @param processedData Vector containing the filtered float data.
+ * @param filepath Output file path.
+ * @param convolutionKernel The kernel used (needed to calculate invalid border samples).
+ * @param sourceData Original EdfData structure to copy metadata from.
+ */
+void save_columnar(const NeonVector& processedData, const std::string& filepath, const std::vector<float>& convolutionKernel, const EdfData& sourceData) {
+    std::cout << "Exporting columnar output: " << filepath << "..." << std::endl;
+
+    const long long numRecords = valid_record_count(sourceData, convolutionKernel.size());
+    std::vector<size_t> sampleCounts;
+    for (const auto& ch : sourceData.channels) sampleCounts.push_back(static_cast<size_t>(numRecords) * ch.smp_in_datarecord);
+
+    const float* dataPtr = processedData.data();
+    const ColumnarSampleType type = COLUMNAR_LOSSLESS_FLOAT ? ColumnarSampleType::FLOAT32_XOR : ColumnarSampleType::DIGITAL_DELTA;
+    write_columnar_file(filepath, sourceData, sampleCounts, type,
+        [&](const int channel, const size_t first, const size_t count, uint32_t* dst) {
+            const float* src = dataPtr + sourceData.channelStarts[channel] + sourceData.padding + first;
+            if (type == ColumnarSampleType::FLOAT32_XOR) {
+                std::memcpy(dst, src, count * sizeof(float));
+                return;
+            }
+
+            // digital = round((physical - offset) / scale), saturated (as encode_digital_samples, for 16- and 24-bit ranges).
+            const EdfChannelParams& params = sourceData.channels[channel];
+            const float invScale = 1.0f / static_cast<float>(params.scale);
+            const float offset = static_cast<float>(params.offset);
+            const float32x4_t offsetVec = vdupq_n_f32(offset);
+            const int32x4_t minVec = vdupq_n_s32(params.dig_min);
+            const int32x4_t maxVec = vdupq_n_s32(params.dig_max);
+            size_t i = 0;
+
+            for (; i + 4 <= count; i += 4) {
+                const int32x4_t digital = vcvtnq_s32_f32(vmulq_n_f32(vsubq_f32(vld1q_f32(src + i), offsetVec), invScale));
+                vst1q_u32(dst + i, vreinterpretq_u32_s32(vminq_s32(vmaxq_s32(digital, minVec), maxVec)));
+            }
+            for (; i < count; ++i) {
+                const long value = std::lround((src[i] - offset) * invScale);
+                dst[i] = static_cast<uint32_t>(static_cast<int32_t>(std::clamp<long>(value, params.dig_min, params.dig_max)));
+            }
+        });
+}
+
+/**
+ * Saves records quantized by the output stage in the columnar format (zigzag deltas of the digital samples,
+ * bit-packed with Neon). Holds exactly the samples save_records writes.
+ *
+ * @param records Quantized output in EDF data-record layout.
+ * @param filepath Output file path.
+ * @param sourceData Original EdfData structure to copy metadata from.
+ */
+void save_columnar_records(const EdfRecordOutput& records, const std::string& filepath, const EdfData& sourceData) {
+    std::cout << "Exporting columnar records: " << filepath << "..." << std::endl;
+
+    std::vector<size_t> sampleCounts;
+    for (const auto& ch : sourceData.channels) sampleCounts.push_back(static_cast<size_t>(records.layout.recordCount) * ch.smp_in_datarecord);
+
+    write_columnar_file(filepath, sourceData, sampleCounts, ColumnarSampleType::DIGITAL_DELTA,
+        [&](const int channel, const size_t first, const size_t count, uint32_t* dst) {
+            const size_t samplesPerRecord = sourceData.channels[channel].smp_in_datarecord;
+            for (size_t i = 0; i < count; ++i) {
+                const size_t sample = first + i;
+                const size_t position = (sample / samplesPerRecord) * records.layout.recordSize + records.layout.channelOffsets[channel] + sample % samplesPerRecord;
+                dst[i] = static_cast<uint32_t>(static_cast<int32_t>(records.data()[position]));
+            }
+        });
+}
+
+/**
+ * Reads a range of physical samples of one channel from a columnar file.
+ * Only the index entries and chunks covering the range are read, the chunks are decoded in parallel.
+ *
+ * @param filepath Columnar file path.
+ * @param channel Channel index.
+ * @param firstSample First sample of the range.
+ * @param count Samples to read (0 returns an empty range).
+ * @return Physical samples of the range.
+ * @throws std::runtime_error if the file is not a columnar output file, the channel does not exist or the range exceeds the channel.
+ */
+std::vector<float> read_columnar_samples(const std::string& filepath, const int channel, const size_t firstSample, const size_t count) {
+    FileDescriptorGuard file(open(filepath.c_str(), O_RDONLY));
+    if (file.fd < 0) {
+        throw std::runtime_error("Error: Could not open file: " + filepath);
+    }
+
+    ColumnarFileHeader header;
+    read_at(file.fd, reinterpret_cast<uint8_t*>(&header), sizeof(header), 0);
+    if (std::memcmp(header.magic, ColumnarMagic, sizeof(header.magic)) != 0 || header.version != ColumnarVersion) {
+        throw std::runtime_error("Error: Not a columnar output file: " + filepath);
+    }
+    if (channel < 0 || channel >= static_cast<int>(header.channelCount)) {
+        throw std::runtime_error("Error: Channel " + std::to_string(channel) + " not found in " + filepath);
+    }
+
+    ColumnarChannelHeader channelHeader;
+    read_at(file.fd, reinterpret_cast<uint8_t*>(&channelHeader), sizeof(channelHeader), static_cast<off_t>(sizeof(header) + channel * sizeof(channelHeader)));
+    if (firstSample > channelHeader.sampleCount || count > channelHeader.sampleCount - firstSample) {
+        throw std::runtime_error("Error: Range exceeds channel " + std::to_string(channel) + " of " + filepath);
+    }
+    if (count == 0) return {};
+
+    const size_t firstChunk = firstSample / header.chunkSamples;
+    const size_t chunkCount = (firstSample + count - 1) / header.chunkSamples - firstChunk + 1;
+    std::vector<ColumnarChunkEntry> index(chunkCount);
+    read_at(file.fd, reinterpret_cast<uint8_t*>(index.data()), chunkCount * sizeof(ColumnarChunkEntry),
+            static_cast<off_t>(header.indexOffset + (channelHeader.firstChunk + firstChunk) * sizeof(ColumnarChunkEntry)));
+
+    const ColumnarScaling scaling(static_cast<ColumnarSampleType>(header.sampleType), channelHeader);
+    const ColumnarSampleType type = scaling.type;
+
+    std::vector<float> samples(count);
+    std::atomic<bool> failed{false};
+
+    const int fd = file.fd;
+    const uint32_t chunkSamples = header.chunkSamples;
+    const ColumnarChunkEntry* indexPtr = index.data();
+    const ColumnarScaling* scalingPtr = &scaling;
+    float* samplesPtr = samples.data();
+    std::atomic<bool>* failedPtr = &failed;
+
+    dispatch_apply(chunkCount, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t i) {
+        const ColumnarChunkEntry& entry = indexPtr[i];
+        IoBuffer encoded(entry.bytes);
+        std::vector<uint32_t> values((entry.samples + ColumnarBlockSamples - 1) / ColumnarBlockSamples * ColumnarBlockSamples);
+        try {
+            read_at(fd, encoded.data(), entry.bytes, static_cast<off_t>(entry.offset));
+        } catch (const std::runtime_error&) {
+            failedPtr->store(true);
+            return;
+        }
+        decode_columnar_chunk(encoded.data(), entry.samples, type, values.data());
+
+        // Part of the chunk inside the requested range.
+        const size_t chunkStart = (firstChunk + i) * chunkSamples;
+        const size_t from = std::max(chunkStart, firstSample);
+        const size_t to = std::min(chunkStart + entry.samples, firstSample + count);
+        for (size_t s = from; s < to; ++s) {
+            samplesPtr[s - firstSample] = scalingPtr->physical(values[s - chunkStart]);
+        }
+    });
+
+    if (failed) {
+        throw std::runtime_error("Error: Reading columnar chunks failed: " + filepath);
+    }
+    return samples;
+}
@@ -7,6 +7,10 @@
 //
 
 #include "io.hpp"
+#include "edf_records.hpp"
+#include "async_io.hpp"
+#include "../half_precision.hpp"
+#include <dispatch/dispatch.h>
 #include <iostream>
 #include <iomanip>
 #include <limits>
@@ -16,7 +20,30 @@
 #include <vector>
 #include <cmath>
 #include <fstream>
+#include <mutex>
+#include <sstream>
 #include <cstring>
+#include <cstdlib>
+#include <cerrno>
+#include <ctime>
+#include <chrono>
+#include <fcntl.h>
+#include <unistd.h>
+
+/**
+ * edflib keeps its open files in a global table without locking, so files are opened and closed under this mutex
+ * (batch runs load several files concurrently).
+ */
+std::mutex& edflib_mutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+// Helper to open an EDF / BDF file with edflib (header and signal parameters in hdr).
+int open_edf_readonly(const char* filePath, edflib_hdr_t& hdr) {
+    std::lock_guard<std::mutex> lock(edflib_mutex());
+    return edfopen_file_readonly(filePath, &hdr, EDFLIB_DO_NOT_READ_ANNOTATIONS);
+}
 
 // RAII wrapper to ensure EDF files are closed properly.
 struct EdfFileGuard {
@@ -26,6 +53,7 @@ struct EdfFileGuard {
     
     ~EdfFileGuard() {
         if (handle >= 0) {
+            std::lock_guard<std::mutex> lock(edflib_mutex());
             edfclose_file(handle);
         }
     }
@@ -41,12 +69,6 @@ std::string clean_string(const char* str) {
     return s;
 }
 
-struct ChannelInfo {
-    int smpInRecord;
-    float scale;
-    float offset;
-};
-
 struct FileMetadata {
     int totalSignals;
     int samplesPerSignal;
@@ -58,142 +80,643 @@ struct FileMetadata {
     size_t dataSize;
 };
 
+// Helper to replicate the first/last value of every signal into its border padding.
+template <typename T>
+void pad_signal_borders(T* samples, const EdfData& data) {
+    for (size_t s = 0; s < data.channelLengths.size(); ++s) {
+        T* dataStart = samples + data.channelStarts[s] + data.padding;
+        const int length = data.channelLengths[s];
+
+        if (length > 0) {
+            std::fill_n(dataStart - data.padding, data.padding, dataStart[0]);
+            std::fill_n(dataStart + length, data.padding, dataStart[length - 1]);
+        }
+    }
+}
+
+// Contiguous byte range within one data record.
+struct ByteRun {
+    size_t offset;
+    size_t size;
+};
+
+// Unselected bytes up to this size between two runs are read anyway (cheaper than another read call).
+constexpr size_t RunMergeGap = 4096;
+
+// Helper to read the record layout of all signals (annotation signals included, edflib hides them) from the raw header.
+void read_raw_record_layout(std::ifstream& file, const int visibleSignals, EdfRecordLayout& layout) {
+    char field[17] = {};
+    file.seekg(252, std::ios::beg);
+    file.read(field, 4);
+    const int rawSignals = std::atoi(field);
+    if (!file || rawSignals < visibleSignals) throw std::runtime_error("Invalid signal count in header");
+
+    std::vector<char> signalHeader(static_cast<size_t>(rawSignals) * 256);
+    file.seekg(256, std::ios::beg);
+    if (!file.read(signalHeader.data(), signalHeader.size())) throw std::runtime_error("Truncated signal header");
+
+    layout.headerSize = 256 + static_cast<size_t>(rawSignals) * 256;
+    layout.recordSize = 0;
+    layout.channelOffsets.clear();
+
+    for (int i = 0; i < rawSignals; ++i) {
+        std::memcpy(field, signalHeader.data() + i * 16, 16);
+        field[16] = '\0';
+        const std::string label = clean_string(field);
+
+        std::memcpy(field, signalHeader.data() + static_cast<size_t>(rawSignals) * 216 + i * 8, 8);
+        field[8] = '\0';
+        const int smpInRecord = std::atoi(field);
+
+        if (label != "EDF Annotations" && label != "BDF Annotations") {
+            layout.channelOffsets.push_back(layout.recordSize);
+        }
+        layout.recordSize += smpInRecord;
+    }
+
+    if (static_cast<int>(layout.channelOffsets.size()) != visibleSignals) {
+        throw std::runtime_error("Signal header does not match the signals reported by edflib");
+    }
+}
+
+// Helper to copy the main header fields from the edflib header.
+EdfHeaderInfo read_header_info(const edflib_hdr_t& hdr, const int numSignals) {
+    EdfHeaderInfo header;
+    header.patient = clean_string(hdr.patient);
+    header.recording = clean_string(hdr.recording);
+    header.startdate_day = hdr.startdate_day;
+    header.startdate_month = hdr.startdate_month;
+    header.startdate_year = hdr.startdate_year;
+    header.starttime_hour = hdr.starttime_hour;
+    header.starttime_minute = hdr.starttime_minute;
+    header.starttime_second = hdr.starttime_second;
+    header.starttime_subsecond = hdr.starttime_subsecond;
+    header.data_record_duration = hdr.datarecord_duration;
+    header.num_signals = numSignals;
+    return header;
+}
+
+// Helper to copy the parameters of one signal from the edflib header, including the digital -> physical mapping.
+EdfChannelParams read_channel_params(const edflib_param_t& param) {
+    EdfChannelParams channel;
+    channel.label = clean_string(param.label);
+    channel.dimension = clean_string(param.physdimension);
+    channel.transducer = clean_string(param.transducer);
+    channel.prefilter = clean_string(param.prefilter);
+    channel.phys_min = param.phys_min;
+    channel.phys_max = param.phys_max;
+    channel.dig_min = param.dig_min;
+    channel.dig_max = param.dig_max;
+    channel.smp_in_datarecord = param.smp_in_datarecord;
+
+    double phys_range = param.phys_max - param.phys_min;
+    double dig_range = param.dig_max - param.dig_min;
+
+    if (dig_range == 0) {
+        channel.scale = 1.0;
+        channel.offset = 0.0;
+    } else {
+        channel.scale = phys_range / dig_range;
+        channel.offset = param.phys_min - param.dig_min * channel.scale;
+    }
+    return channel;
+}
+
+// Helper to set the record layout, the record count (whole records in the file) and the channel lengths of unpadded metadata.
+void read_file_record_layout(const char* filePath, const bool is24Bit, EdfData& data) {
+    std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+    if (!file) throw std::runtime_error("Cannot open file binary");
+    const size_t fileSize = file.tellg();
+
+    read_raw_record_layout(file, static_cast<int>(data.channels.size()), data.records);
+    data.records.filePath = filePath;
+    data.records.bytesPerSample = is24Bit ? 3 : 2;
+    data.records.recordCount = (fileSize - data.records.headerSize) / (data.records.recordSize * data.records.bytesPerSample);
+
+    data.totalSamplesPadded = 0;
+    data.channelStarts.clear();
+    data.channelLengths.clear();
+    for (const auto& ch : data.channels) {
+        const long long length = data.records.recordCount * ch.smp_in_datarecord;
+        if (length > std::numeric_limits<int>::max()) throw std::runtime_error("Sample count too high");
+
+        data.channelStarts.push_back(data.totalSamplesPadded);
+        data.channelLengths.push_back(static_cast<int>(length));
+        data.totalSamplesPadded += static_cast<size_t>(data.channelLengths.back());
+    }
+}
+
+/**
+ * Reads the header, the parameters of all channels and the record layout of an EDF / BDF file without reading samples.
+ * Channel starts and lengths describe the whole recording without padding.
+ *
+ * @param filePath Path to the .edf / .bdf file.
+ * @throws std::runtime_error if the header cannot be read or has no signals.
+ */
+EdfData read_edf_metadata(const char* filePath) {
+    edflib_hdr_t hdr;
+    if (open_edf_readonly(filePath, hdr) < 0) {
+        throw std::runtime_error("Header load failed");
+    }
+    EdfFileGuard fileGuard(hdr.handle);
+
+    if (hdr.edfsignals <= 0) {
+        throw std::runtime_error("No signals found");
+    }
+
+    const bool is24Bit = (hdr.filetype == EDFLIB_FILETYPE_BDF || hdr.filetype == EDFLIB_FILETYPE_BDFPLUS);
+
+    EdfData data;
+    data.padding = 0;
+    data.header = read_header_info(hdr, hdr.edfsignals);
+    for (int i = 0; i < hdr.edfsignals; ++i) {
+        data.channels.push_back(read_channel_params(hdr.signalparam[i]));
+    }
+
+    read_file_record_layout(filePath, is24Bit, data);
+    return data;
+}
+
+// Helper to copy a fixed-width header field into a null-terminated buffer of at least width + 1 bytes.
+void copy_header_field(char* dst, const char* src, const size_t width) {
+    std::memcpy(dst, src, width);
+    dst[width] = '\0';
+}
+
+/**
+ * Same as read_edf_metadata, for recordings that are still being written. edflib rejects those files
+ * (the header holds -1 or a stale record count, the last record may be incomplete), so the header is parsed
+ * directly into the edflib structures. The record count covers the whole data records present in the file.
+ *
+ * @param filePath Path to the .edf / .bdf file.
+ * @throws std::runtime_error if the header cannot be read or has no signals.
+ */
+EdfData read_growing_edf_metadata(const char* filePath) {
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file) throw std::runtime_error("Cannot open file binary");
+
+    char mainHeader[256];
+    if (!file.read(mainHeader, sizeof(mainHeader))) throw std::runtime_error("Header load failed");
+
+    char field[81];
+    copy_header_field(field, mainHeader + 252, 4);
+    const int rawSignals = std::atoi(field);
+    if (rawSignals <= 0) throw std::runtime_error("No signals found");
+
+    std::vector<char> signalHeader(static_cast<size_t>(rawSignals) * 256);
+    if (!file.read(signalHeader.data(), signalHeader.size())) throw std::runtime_error("Truncated signal header");
+
+    edflib_hdr_t hdr = {};
+    copy_header_field(hdr.patient, mainHeader + 8, 80);
+    copy_header_field(hdr.recording, mainHeader + 88, 80);
+
+    copy_header_field(field, mainHeader + 168, 16);
+    int year = 0;
+    if (std::sscanf(field, "%2d.%2d.%2d%2d.%2d.%2d", &hdr.startdate_day, &hdr.startdate_month, &year,
+                    &hdr.starttime_hour, &hdr.starttime_minute, &hdr.starttime_second) != 6) {
+        throw std::runtime_error("Invalid start date / time in header");
+    }
+    // Two-digit years: 85 - 99 are 1985 - 1999 (EDF clipping date).
+    hdr.startdate_year = year + (year >= 85 ? 1900 : 2000);
+
+    copy_header_field(field, mainHeader + 244, 8);
+    hdr.datarecord_duration = std::llround(std::atof(field) * EDFLIB_TIME_DIMENSION);
+
+    // Signal fields are stored field by field for all signals.
+    const char* fields = signalHeader.data();
+    const size_t n = static_cast<size_t>(rawSignals);
+    EdfData data;
+    data.padding = 0;
+    for (size_t i = 0; i < n; ++i) {
+        edflib_param_t param = {};
+        copy_header_field(param.label, fields + i * 16, 16);
+        if (clean_string(param.label) == "EDF Annotations" || clean_string(param.label) == "BDF Annotations") continue;
+
+        copy_header_field(param.transducer, fields + n * 16 + i * 80, 80);
+        copy_header_field(param.physdimension, fields + n * 96 + i * 8, 8);
+        copy_header_field(field, fields + n * 104 + i * 8, 8);
+        param.phys_min = std::atof(field);
+        copy_header_field(field, fields + n * 112 + i * 8, 8);
+        param.phys_max = std::atof(field);
+        copy_header_field(field, fields + n * 120 + i * 8, 8);
+        param.dig_min = std::atoi(field);
+        copy_header_field(field, fields + n * 128 + i * 8, 8);
+        param.dig_max = std::atoi(field);
+        copy_header_field(param.prefilter, fields + n * 136 + i * 80, 80);
+        copy_header_field(field, fields + n * 216 + i * 8, 8);
+        param.smp_in_datarecord = std::atoi(field);
+        if (param.smp_in_datarecord <= 0) throw std::runtime_error("Invalid samples per record in header");
+
+        data.channels.push_back(read_channel_params(param));
+    }
+    if (data.channels.empty()) throw std::runtime_error("No signals found");
+
+    data.header = read_header_info(hdr, static_cast<int>(data.channels.size()));
+    read_file_record_layout(filePath, static_cast<uint8_t>(mainHeader[0]) == 0xFF, data);
+    return data;
+}
+
+// Helper to map channel labels to signal indices (all signals when no label is given).
+std::vector<int> resolve_channel_selection(const edflib_hdr_t& hdr, const std::vector<std::string>& labels) {
+    std::vector<int> selected;
+    if (labels.empty()) {
+        for (int i = 0; i < hdr.edfsignals; ++i) selected.push_back(i);
+        return selected;
+    }
+
+    for (const auto& label : labels) {
+        int found = -1;
+        for (int i = 0; i < hdr.edfsignals && found < 0; ++i) {
+            if (clean_string(hdr.signalparam[i].label) == label) found = i;
+        }
+        if (found < 0) throw std::runtime_error("Channel not found: " + label);
+        if (std::find(selected.begin(), selected.end(), found) == selected.end()) selected.push_back(found);
+    }
+    return selected;
+}
+
+// Helper to append a run (offsets ascending), merging it with the previous run when the gap is at most RunMergeGap.
+void append_run(std::vector<ByteRun>& runs, const ByteRun& run) {
+    if (!runs.empty() && run.offset <= runs.back().offset + runs.back().size + RunMergeGap) {
+        runs.back().size = std::max(runs.back().size, run.offset + run.size - runs.back().offset);
+    } else {
+        runs.push_back(run);
+    }
+}
+
+// Helper to collect the byte ranges of the selected channels within one data record, merged into as few runs as possible.
+std::vector<ByteRun> selected_record_runs(const EdfRecordLayout& layout, const std::vector<int>& smpInRecord) {
+    std::vector<ByteRun> runs;
+    for (size_t j = 0; j < layout.channelOffsets.size(); ++j) {
+        runs.push_back({layout.channelOffsets[j] * layout.bytesPerSample, static_cast<size_t>(smpInRecord[j]) * layout.bytesPerSample});
+    }
+    std::sort(runs.begin(), runs.end(), [](const ByteRun& a, const ByteRun& b) { return a.offset < b.offset; });
+
+    std::vector<ByteRun> merged;
+    for (const ByteRun& run : runs) append_run(merged, run);
+    return merged;
+}
+
+// Helper to lay the runs of one record out over consecutive records, a run ending near the end of a record
+// is merged with the first run of the next record.
+std::vector<ByteRun> block_record_runs(const std::vector<ByteRun>& recordRuns, const size_t recordCount, const size_t bytesPerRecord) {
+    std::vector<ByteRun> merged;
+    for (size_t r = 0; r < recordCount; ++r) {
+        for (const ByteRun& run : recordRuns) append_run(merged, {r * bytesPerRecord + run.offset, run.size});
+    }
+    return merged;
+}
+
+// Helper to move the header start time to the first loaded data record (offset in units of 100 ns, like edflib).
+void shift_start_time(EdfHeaderInfo& header, const long long offset) {
+    if (offset == 0) return;
+
+    // Records may last fractions of a second, the part below a second is carried in starttime_subsecond.
+    const long long subsecond = header.starttime_subsecond + offset;
+    const long long seconds = subsecond / EDFLIB_TIME_DIMENSION;
+    header.starttime_subsecond = subsecond % EDFLIB_TIME_DIMENSION;
+
+    std::tm t = {};
+    t.tm_year = header.startdate_year - 1900;
+    t.tm_mon = header.startdate_month - 1;
+    t.tm_mday = header.startdate_day;
+    t.tm_hour = header.starttime_hour;
+    t.tm_min = header.starttime_minute;
+    t.tm_sec = header.starttime_second;
+
+    const time_t shifted = timegm(&t) + static_cast<time_t>(seconds);
+    gmtime_r(&shifted, &t);
+
+    header.startdate_year = t.tm_year + 1900;
+    header.startdate_month = t.tm_mon + 1;
+    header.startdate_day = t.tm_mday;
+    header.starttime_hour = t.tm_hour;
+    header.starttime_minute = t.tm_min;
+    header.starttime_second = t.tm_sec;
+}
+
 /**
- * Loads an EDF file into memory.
- * Reads metadata, converts raw digital values to physical float values,
- * arranges data into a single continuous vector, and applies border padding.
+ * Reads the labels of all signals (annotation signals excluded), used to offer the channel selection.
+ *
+ * @param filePath Path to the .edf / .bdf file.
+ * @throws std::runtime_error if the header cannot be read.
+ */
+std::vector<std::string> read_channel_labels(const char* filePath) {
+    edflib_hdr_t hdr;
+    if (open_edf_readonly(filePath, hdr) < 0) {
+        throw std::runtime_error("Header load failed");
+    }
+    EdfFileGuard fileGuard(hdr.handle);
+
+    std::vector<std::string> labels;
+    for (int i = 0; i < hdr.edfsignals; ++i) labels.push_back(clean_string(hdr.signalparam[i].label));
+    return labels;
+}
+
+/**
+ * Decodes an EDF or BDF file into memory.
+ * Reads metadata, converts raw digital values to physical float values (and/or keeps
+ * the raw int16 digital values), arranges data into a single continuous vector, and applies border padding.
+ * BDF(+) files store 24-bit samples, which are unpacked with Neon table lookups and cannot be kept as int16.
+ *
+ * Only the selected channels and data records are read: the byte ranges of the selected channels within
+ * a record are merged into runs (also across consecutive records) and read with pread, so I/O and decoding
+ * shrink with the selection. Up to IO_BLOCK_BYTES of consecutive records form one block (runs covering
+ * (almost) whole records are read in one call).
+ * IO_QUEUE_DEPTH blocks are read asynchronously while the blocks that already arrived are decoded.
+ * With SAMPLE_CACHE_ENABLED, the decoded samples are written to a sidecar file and later loads read it back.
  *
- * @param filePath Path to the .edf file.
+ * @param filePath Path to the .edf / .bdf file.
  * @param padding Number of elements to pad at the beginning and end of each signal.
+ * @param format Sample representation(s) to keep in memory (FLOAT32, INT16, FLOAT32_AND_INT16 or NONE).
+ * @param selection Channels (by label) and time window to load.
  * @return EdfData structure containing samples and header info.
+ * @throws std::runtime_error if a BDF file is loaded for the fixed-point or fused modes (they need 16-bit samples),
+ *         a selected channel does not exist or the time window lies outside the recording.
  */
-EdfData load_edf_data(const char* filePath, const int padding) {
+EdfData decode_edf_data(const char* filePath, const int padding, const SampleFormat format, const LoadSelection& selection) {
     std::cout << "Loading file: " << filePath << "\n";
 
+    // SampleFormat::NONE keeps no samples, there is nothing to cache.
+    const bool useCache = SAMPLE_CACHE_ENABLED && format != SampleFormat::NONE;
+    if (useCache) {
+        EdfData cached;
+        if (load_sample_cache(filePath, padding, format, selection, cached)) return cached;
+    }
+
     edflib_hdr_t hdr;
-    if (edfopen_file_readonly(filePath, &hdr, EDFLIB_DO_NOT_READ_ANNOTATIONS) < 0) {
+    if (open_edf_readonly(filePath, hdr) < 0) {
         throw std::runtime_error("Header load failed");
     }
 
     EdfFileGuard fileGuard(hdr.handle);
 
-    EdfData resultData;
-    resultData.padding = padding;
-    
-    resultData.header.patient = clean_string(hdr.patient);
-    resultData.header.recording = clean_string(hdr.recording);
-    resultData.header.startdate_day = hdr.startdate_day;
-    resultData.header.startdate_month = hdr.startdate_month;
-    resultData.header.startdate_year = hdr.startdate_year;
-    resultData.header.starttime_hour = hdr.starttime_hour;
-    resultData.header.starttime_minute = hdr.starttime_minute;
-    resultData.header.starttime_second = hdr.starttime_second;
-    resultData.header.data_record_duration = hdr.datarecord_duration;
-    resultData.header.num_signals = hdr.edfsignals;
+    const bool is24Bit = (hdr.filetype == EDFLIB_FILETYPE_BDF || hdr.filetype == EDFLIB_FILETYPE_BDFPLUS);
+    if (is24Bit && (format == SampleFormat::INT16 || format == SampleFormat::NONE)) {
+        throw std::runtime_error("Fixed-point and fused modes require 16-bit EDF samples (BDF stores 24-bit samples)");
+    }
+    const size_t bytesPerSample = is24Bit ? 3 : 2;
 
     if (hdr.edfsignals <= 0) {
         throw std::runtime_error("No signals found");
     }
 
-    long long samplesPerSignalLL = hdr.signalparam[0].smp_in_file;
-    for (int s = 0; s < hdr.edfsignals; ++s) {
-        if (hdr.signalparam[s].smp_in_file != samplesPerSignalLL) {
-            throw std::runtime_error("Signals have mismatching sample counts.");
-        }
-    }
-    if (samplesPerSignalLL > std::numeric_limits<int>::max()) throw std::runtime_error("Sample count too high");
-    
-    resultData.samplesPerSignal = static_cast<int>(samplesPerSignalLL);
-    resultData.samplesPerSignalPadded = resultData.samplesPerSignal + (2 * padding);
-    
-    std::vector<ChannelInfo> loadParams(hdr.edfsignals);
-    resultData.channels.resize(hdr.edfsignals);
-    
-    int bytesPerRecord = 0;
+    const std::vector<int> selected = resolve_channel_selection(hdr, selection.channels);
+    const int channelCount = static_cast<int>(selected.size());
 
-    for (int i = 0; i < hdr.edfsignals; ++i) {
-        resultData.channels[i].label = clean_string(hdr.signalparam[i].label);
-        resultData.channels[i].dimension = clean_string(hdr.signalparam[i].physdimension);
-        resultData.channels[i].transducer = clean_string(hdr.signalparam[i].transducer);
-        resultData.channels[i].prefilter = clean_string(hdr.signalparam[i].prefilter);
-        resultData.channels[i].phys_min = hdr.signalparam[i].phys_min;
-        resultData.channels[i].phys_max = hdr.signalparam[i].phys_max;
-        resultData.channels[i].dig_min = hdr.signalparam[i].dig_min;
-        resultData.channels[i].dig_max = hdr.signalparam[i].dig_max;
-        resultData.channels[i].smp_in_datarecord = hdr.signalparam[i].smp_in_datarecord;
-
-        loadParams[i].smpInRecord = hdr.signalparam[i].smp_in_datarecord;
-        bytesPerRecord += loadParams[i].smpInRecord * 2;
-
-        double phys_range = hdr.signalparam[i].phys_max - hdr.signalparam[i].phys_min;
-        double dig_range = hdr.signalparam[i].dig_max - hdr.signalparam[i].dig_min;
-
-        if (dig_range == 0) {
-             loadParams[i].scale = 1.0f;
-             loadParams[i].offset = 0.0f;
-        } else {
-             loadParams[i].scale = static_cast<float>(phys_range / dig_range);
-             loadParams[i].offset = static_cast<float>(hdr.signalparam[i].phys_min - (hdr.signalparam[i].dig_min * loadParams[i].scale));
-        }
+    EdfData resultData;
+    resultData.padding = padding;
+    resultData.header = read_header_info(hdr, channelCount);
+
+    std::vector<ChannelInfo> loadParams(channelCount);
+    std::vector<int> smpInRecord(channelCount);
+    resultData.channels.resize(channelCount);
+    
+    for (int i = 0; i < channelCount; ++i) {
+        resultData.channels[i] = read_channel_params(hdr.signalparam[selected[i]]);
+        loadParams[i] = channel_info(resultData.channels[i]);
+        smpInRecord[i] = resultData.channels[i].smp_in_datarecord;
     }
 
-    size_t headerSize = 256 + (hdr.edfsignals * 256);
     std::ifstream file(filePath, std::ios::binary | std::ios::ate);
     if (!file) throw std::runtime_error("Cannot open file binary");
     size_t fileSize = file.tellg();
-    size_t dataSize = fileSize - headerSize;
-    long long numRecords = dataSize / bytesPerRecord;
 
-    size_t totalSamplesPadded = static_cast<size_t>(hdr.edfsignals) * resultData.samplesPerSignalPadded;
-    resultData.samples.resize(totalSamplesPadded);
+    EdfRecordLayout fileLayout;
+    read_raw_record_layout(file, hdr.edfsignals, fileLayout);
+    file.close();
+
+    const size_t bytesPerRecord = fileLayout.recordSize * bytesPerSample;
+    size_t dataSize = fileSize - fileLayout.headerSize;
+    const long long fileRecords = dataSize / bytesPerRecord;
+
+    // Time window, rounded outwards to whole data records.
+    long long firstRecord = 0;
+    long long endRecord = fileRecords;
+    if (selection.startSec > 0.0 || selection.durationSec > 0.0) {
+        const double recordSec = static_cast<double>(hdr.datarecord_duration) / EDFLIB_TIME_DIMENSION;
+        if (recordSec <= 0.0) throw std::runtime_error("Time window requires a positive data record duration");
+
+        firstRecord = static_cast<long long>(std::floor(selection.startSec / recordSec));
+        if (selection.durationSec > 0.0) {
+            endRecord = std::min(fileRecords, static_cast<long long>(std::ceil((selection.startSec + selection.durationSec) / recordSec)));
+        }
+        if (firstRecord >= endRecord) throw std::runtime_error("Time window starts after the end of the recording");
+    }
+    const long long numRecords = endRecord - firstRecord;
+    shift_start_time(resultData.header, firstRecord * hdr.datarecord_duration);
+
+    resultData.records.filePath = filePath;
+    resultData.records.bytesPerSample = bytesPerSample;
+    resultData.records.headerSize = fileLayout.headerSize + static_cast<size_t>(firstRecord) * bytesPerRecord;
+    resultData.records.recordSize = fileLayout.recordSize;
+    resultData.records.recordCount = numRecords;
+    for (int i = 0; i < channelCount; ++i) {
+        resultData.records.channelOffsets.push_back(fileLayout.channelOffsets[selected[i]]);
+    }
+
+    // Channels may be sampled at different rates, every channel gets its own padded block.
+    resultData.channelStarts.resize(channelCount);
+    resultData.channelLengths.resize(channelCount);
+    resultData.totalSamplesPadded = 0;
+    for (int s = 0; s < channelCount; ++s) {
+        const long long length = numRecords * smpInRecord[s];
+        if (length > std::numeric_limits<int>::max()) throw std::runtime_error("Sample count too high");
+
+        resultData.channelStarts[s] = resultData.totalSamplesPadded;
+        resultData.channelLengths[s] = static_cast<int>(length);
+        resultData.totalSamplesPadded += resultData.channel_length_padded(s);
+    }
+
+    const bool keepPhysical = (format == SampleFormat::FLOAT32 || format == SampleFormat::FLOAT32_AND_INT16);
+    // 24-bit samples do not fit int16, the suite runs only the float modes on BDF files.
+    const bool keepDigital = !is24Bit && (format == SampleFormat::INT16 || format == SampleFormat::FLOAT32_AND_INT16);
 
-    file.seekg(headerSize, std::ios::beg);
+    if (keepPhysical) resultData.samples.resize(resultData.totalSamplesPadded);
+    if (keepDigital) resultData.digitalSamples.resize(resultData.totalSamplesPadded);
 
-    std::vector<int16_t> recordBuffer(bytesPerRecord / 2);
-    std::vector<float*> channelWritePtrs(hdr.edfsignals);
+    std::vector<float*> channelWritePtrs(channelCount);
+    std::vector<int16_t*> channelDigitalPtrs(channelCount);
     
-    for(int s = 0; s < hdr.edfsignals; ++s) {
-        channelWritePtrs[s] = &resultData.samples[static_cast<size_t>(s) * resultData.samplesPerSignalPadded + padding];
+    for(int s = 0; s < channelCount; ++s) {
+        const size_t channelStart = resultData.channelStarts[s] + padding;
+        channelWritePtrs[s] = keepPhysical ? resultData.samples.data() + channelStart : nullptr;
+        channelDigitalPtrs[s] = keepDigital ? resultData.digitalSamples.data() + channelStart : nullptr;
+    }
+
+    // Runs covering (almost) the whole record are extended to it, so consecutive records are read in one call.
+    std::vector<ByteRun> runs = selected_record_runs(resultData.records, smpInRecord);
+    const bool wholeRecords = runs.size() == 1 && bytesPerRecord - runs[0].size <= RunMergeGap;
+    if (wholeRecords) runs[0] = {0, bytesPerRecord};
+    const long long recordsPerBlock = std::max(1LL, static_cast<long long>(IO_BLOCK_BYTES / bytesPerRecord));
+    size_t runBytes = 0;
+    for (const ByteRun& run : runs) runBytes += run.size;
+
+    // SampleFormat::NONE keeps only the metadata, the records are read later by the fused modes.
+    const long long recordsToRead = (keepPhysical || keepDigital) ? numRecords : 0;
+    const size_t blockCount = static_cast<size_t>((recordsToRead + recordsPerBlock - 1) / recordsPerBlock);
+    size_t bytesRead = 0;
+
+    // Selected runs of a full and of the last (possibly shorter) block, merged across record boundaries.
+    std::vector<ByteRun> fullBlockRuns;
+    std::vector<ByteRun> lastBlockRuns;
+    if (!wholeRecords && blockCount > 0) {
+        fullBlockRuns = block_record_runs(runs, static_cast<size_t>(recordsPerBlock), bytesPerRecord);
+        lastBlockRuns = block_record_runs(runs, static_cast<size_t>(recordsToRead - static_cast<long long>(blockCount - 1) * recordsPerBlock), bytesPerRecord);
     }
 
-    for (long long r = 0; r < numRecords; ++r) {
-        if (!file.read(reinterpret_cast<char*>(recordBuffer.data()), bytesPerRecord)) {
-             if (file.gcount() == 0) break;
+    // Direct reads need aligned offsets and sizes: whole blocks are read from the enclosing aligned range.
+    // Selected runs are read through the page cache.
+    const bool directReads = IO_DIRECT_READS && wholeRecords;
+    FileDescriptorGuard fdGuard(open_for_reading(filePath, directReads));
+    if (fdGuard.fd < 0) throw std::runtime_error("Cannot open file binary");
+
+    auto block_records = [&](const size_t block) {
+        return std::min(recordsPerBlock, recordsToRead - static_cast<long long>(block) * recordsPerBlock);
+    };
+    auto block_offset = [&](const size_t block) {
+        return resultData.records.headerSize + block * static_cast<size_t>(recordsPerBlock) * bytesPerRecord;
+    };
+    // Bytes between the aligned start of a direct read and the first record of the block.
+    auto block_lead = [&](const size_t block) {
+        return directReads ? block_offset(block) % DirectIoAlignment : 0;
+    };
+
+    auto read_block = [&](const size_t block, uint8_t* buffer) {
+        const size_t offset = block_offset(block);
+        const size_t bytes = static_cast<size_t>(block_records(block)) * bytesPerRecord;
+
+        if (directReads) {
+            const size_t lead = block_lead(block);
+            const size_t alignedBytes = (lead + bytes + DirectIoAlignment - 1) / DirectIoAlignment * DirectIoAlignment;
+            read_at_least(fdGuard.fd, buffer, alignedBytes, lead + bytes, static_cast<off_t>(offset - lead));
+        } else if (wholeRecords) {
+            read_at(fdGuard.fd, buffer, bytes, static_cast<off_t>(offset));
+        } else {
+            for (const ByteRun& run : (block + 1 < blockCount) ? fullBlockRuns : lastBlockRuns) {
+                read_at(fdGuard.fd, buffer + run.offset, run.size, static_cast<off_t>(offset + run.offset));
+            }
         }
+    };
+
+    auto decode_block = [&](const size_t block, const uint8_t* buffer) {
+        const long long batch = block_records(block);
+        const uint8_t* records = buffer + block_lead(block);
+        bytesRead += static_cast<size_t>(batch) * runBytes;
 
-        int bufferOffset = 0;
-        for (int s = 0; s < hdr.edfsignals; ++s) {
-            const auto& ch = loadParams[s];
-            float* dst = channelWritePtrs[s];
+        for (long long b = 0; b < batch; ++b) {
+            const uint8_t* record = records + static_cast<size_t>(b) * bytesPerRecord;
 
-            for (int k = 0; k < ch.smpInRecord; ++k) {
-                *dst = static_cast<float>(recordBuffer[bufferOffset++]) * ch.scale + ch.offset;
-                dst++;
+            for (int s = 0; s < channelCount; ++s) {
+                const auto& ch = loadParams[s];
+                const uint8_t* src = record + resultData.records.channelOffsets[s] * bytesPerSample;
+
+                if (keepPhysical) {
+                    if (is24Bit) {
+                        decode_bdf_samples(src, channelWritePtrs[s], ch.smpInRecord, ch.scale, ch.offset);
+                    } else {
+                        decode_digital_samples(reinterpret_cast<const int16_t*>(src), channelWritePtrs[s], ch.smpInRecord, ch.scale, ch.offset);
+                    }
+                    channelWritePtrs[s] += ch.smpInRecord;
+                }
+
+                if (keepDigital) {
+                    std::memcpy(channelDigitalPtrs[s], src, ch.smpInRecord * sizeof(int16_t));
+                    channelDigitalPtrs[s] += ch.smpInRecord;
+                }
             }
-            
-            channelWritePtrs[s] = dst;
         }
-    }
+    };
 
-    file.close();
+    const size_t bufferBytes = static_cast<size_t>(recordsPerBlock) * bytesPerRecord + (directReads ? 2 * DirectIoAlignment : 0);
+    const auto ioStart = std::chrono::high_resolution_clock::now();
+    const double ioWaitSec = pipelined_read(blockCount, bufferBytes, read_block, decode_block);
+    const double ioTotalSec = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - ioStart).count();
 
     // Apply border padding (replicate first/last value)
-    for (int s = 0; s < hdr.edfsignals; ++s) {
-        float* dataStart = &resultData.samples[static_cast<size_t>(s) * resultData.samplesPerSignalPadded + padding];
-        
-        if (resultData.samplesPerSignal > 0) {
-            float firstVal = dataStart[0];
-            std::fill_n(dataStart - padding, padding, firstVal);
-
-            float lastVal = dataStart[resultData.samplesPerSignal - 1];
-            std::fill_n(dataStart + resultData.samplesPerSignal, padding, lastVal);
-        }
+    if (keepPhysical) {
+        pad_signal_borders(resultData.samples.data(), resultData);
+    }
+    if (keepDigital) {
+        pad_signal_borders(resultData.digitalSamples.data(), resultData);
     }
     
-    std::cout << "Signal count: " << hdr.edfsignals << "\n";
-    std::cout << "Samples per signal: " << resultData.samplesPerSignal << "\n";
-    std::cout << "Data size: " << (dataSize / 1024 / 1024) << " MB\n";
-    std::cout << "========================================\n";
+    // Printed at once, so the summaries of files loaded concurrently (batch runs) do not interleave.
+    std::ostringstream summary;
+    summary << "Format: " << (is24Bit ? "BDF (24-bit)" : "EDF (16-bit)") << "\n";
+    summary << "Signal count: " << channelCount;
+    if (channelCount != hdr.edfsignals) summary << " (of " << hdr.edfsignals << ")";
+    summary << "\n";
+    if (numRecords != fileRecords) {
+        summary << "Data records: " << firstRecord << " - " << endRecord << " (of " << fileRecords << ")\n";
+    }
+    const auto [shortest, longest] = std::minmax_element(resultData.channelLengths.begin(), resultData.channelLengths.end());
+    summary << "Samples per signal: " << *longest;
+    if (*shortest != *longest) summary << " (mixed rates, shortest " << *shortest << ")";
+    summary << "\n";
+    summary << "Data size: " << (dataSize / 1024 / 1024) << " MB";
+    if (bytesRead > 0 && bytesRead < dataSize) {
+        summary << " (read " << std::fixed << std::setprecision(1) << (bytesRead / 1024.0 / 1024.0) << " MB)" << std::defaultfloat;
+    }
+    summary << "\n";
+    if (blockCount > 0) {
+        summary << "Read + decode: " << ioTotalSec << "s (waited " << ioWaitSec << "s for I/O, queue depth "
+                << std::min(static_cast<size_t>(IO_QUEUE_DEPTH), blockCount) << (directReads ? ", direct" : "") << ")\n";
+    }
+    summary << "========================================\n";
+    std::cout << summary.str() << std::flush;
+
+    if (useCache) save_sample_cache(filePath, padding, format, selection, resultData);
 
     return resultData;
 }
+
+/**
+ * Narrows the physical samples to FP16 (EdfData::halfSamples), chunks in parallel.
+ *
+ * @param data Loaded data with physical samples.
+ * @param keepPhysical Keeps the float samples, otherwise they are released.
+ * @throws std::runtime_error if a sample exceeds the FP16 range.
+ */
+void narrow_half_samples(EdfData& data, const bool keepPhysical) {
+    constexpr size_t ChunkSamples = 1 << 16;
+    const size_t size = data.samples.size();
+    const size_t numChunks = (size + ChunkSamples - 1) / ChunkSamples;
+    data.halfSamples.resize(size);
+
+    const float* srcPtr = data.samples.data();
+    float16_t* dstPtr = data.halfSamples.data();
+    std::vector<float> chunkMax(numChunks, 0.0f);
+    float* chunkMaxPtr = chunkMax.data();
+
+    dispatch_apply(numChunks, dispatch_get_global_queue(QOS_CLASS_USER_INTERACTIVE, 0), ^(size_t chunkIndex) {
+        const size_t start = chunkIndex * ChunkSamples;
+        chunkMaxPtr[chunkIndex] = fp16_narrow_range(srcPtr + start, dstPtr + start, std::min(ChunkSamples, size - start));
+    });
+
+    if (!chunkMax.empty() && *std::max_element(chunkMax.begin(), chunkMax.end()) > FP16_MAX) {
+        throw std::runtime_error("Samples exceed the FP16 range");
+    }
+    if (!keepPhysical) NeonVector().swap(data.samples);
+}
+
+/**
+ * Loads an EDF or BDF file into memory (see decode_edf_data).
+ * FP16 samples are narrowed from the decoded physical values, which are released unless the format keeps them.
+ *
+ * @param filePath Path to the .edf / .bdf file.
+ * @param padding Number of elements to pad at the beginning and end of each signal.
+ * @param format Sample representation(s) to keep in memory.
+ * @param selection Channels (by label) and time window to load.
+ */
+EdfData load_edf_data(const char* filePath, const int padding, const SampleFormat format, const LoadSelection& selection) {
+    SampleFormat decodeFormat = format;
+    if (format == SampleFormat::FLOAT16) decodeFormat = SampleFormat::FLOAT32;
+    if (format == SampleFormat::ALL) decodeFormat = SampleFormat::FLOAT32_AND_INT16;
+
+    EdfData data = decode_edf_data(filePath, padding, decodeFormat, selection);
+    if (format == SampleFormat::FLOAT16 || format == SampleFormat::ALL) {
+        narrow_half_samples(data, format == SampleFormat::ALL);
+    }
+    return data;
+}
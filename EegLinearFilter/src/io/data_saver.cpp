@@ -7,12 +7,19 @@
 //
 
 #include "io.hpp"
+#include "edf_records.hpp"
+#include "async_io.hpp"
 #include <iostream>
 #include <vector>
 #include <string>
 #include <filesystem>
 #include <stdexcept>
 #include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <chrono>
+#include <memory>
 
 // Helper to copy strings safely into fixed-size buffers.
 void copy_string_to_buffer(char* buffer, const std::string& source, size_t size) {
@@ -24,7 +31,7 @@ void copy_string_to_buffer(char* buffer, const std::string& source, size_t size)
 }
 
 /**
- * Saves processed data to a new EDF file.
+ * Saves processed data to a new EDF+ file (BDF+ for BDF sources).
  * Handles header creation and writing of physical samples.
  *
  * @param processedData Vector containing the filtered float data.
@@ -35,19 +42,30 @@ void copy_string_to_buffer(char* buffer, const std::string& source, size_t size)
 void save_data(const NeonVector& processedData, const std::string& filepath, const std::vector<float>& convolutionKernel, const EdfData& sourceData) {
     std::cout << "Exporting to EDF: " << filepath << "..." << std::endl;
 
+    // 16-bit sources: the workers quantize whole records straight into the mapped output file (plain EDF, written in parallel).
+    if (MAPPED_EDF_OUTPUT && sourceData.records.bytesPerSample == sizeof(int16_t)) {
+        EdfRecordOutput records = create_mapped_record_output(sourceData, convolutionKernel.size(), filepath);
+        quantize_output_records<CHUNK_SIZE>(sourceData, processedData, records);
+        finish_mapped_records(records);
+        return;
+    }
+
     std::filesystem::path pathObj(filepath);
     std::filesystem::path dirPath = pathObj.parent_path();
     if (!dirPath.empty() && !std::filesystem::exists(dirPath)) {
         std::filesystem::create_directories(dirPath);
     }
 
-    int fileType = EDFLIB_FILETYPE_EDFPLUS;
+    // 24-bit sources keep their digital range, so they are written as BDF+.
+    int fileType = (sourceData.records.bytesPerSample == 3) ? EDFLIB_FILETYPE_BDFPLUS : EDFLIB_FILETYPE_EDFPLUS;
     int channelCount = sourceData.header.num_signals;
 
     if (channelCount < 1) {
         throw std::runtime_error("Error: No channels to save.");
     }
 
+    // The whole export goes through edflib's global file table (see edflib_mutex).
+    std::lock_guard<std::mutex> edflibLock(edflib_mutex());
     int handle = edfopen_file_writeonly(filepath.c_str(), fileType, channelCount);
     if (handle < 0) {
         throw std::runtime_error("Error: Could not open file for writing (edflib error code: " + std::to_string(handle) + ")");
@@ -60,6 +78,7 @@ void save_data(const NeonVector& processedData, const std::string& filepath, con
         sourceData.header.starttime_hour,
         sourceData.header.starttime_minute,
         sourceData.header.starttime_second);
+    edf_set_subsecond_starttime(handle, static_cast<int>(sourceData.header.starttime_subsecond));
 
     edf_set_patientname(handle, sourceData.header.patient.c_str());
     edf_set_patientcode(handle, "EEG_BENCHMARK_EXPORT");
@@ -79,22 +98,16 @@ void save_data(const NeonVector& processedData, const std::string& filepath, con
         edf_set_prefilter(handle, i, "Linear Convolution Filter");
     }
 
-    size_t kernelSize = convolutionKernel.size();
-    size_t invalidSamples = kernelSize - 1;
-    
-    int originalSamplesPerSignal = sourceData.samplesPerSignal;
-    
-    int validSamplesPerSignal = originalSamplesPerSignal - (int)invalidSamples;
-    if (validSamplesPerSignal < 0) validSamplesPerSignal = 0;
-
-    int smpPerRecord = sourceData.channels[0].smp_in_datarecord;
-    long long numRecords = validSamplesPerSignal / smpPerRecord;
+    // Every channel keeps its own samples per record, the shortest channel (in records) sets the record count.
+    long long numRecords = valid_record_count(sourceData, convolutionKernel.size());
 
-    std::vector<double> writeBuffer(smpPerRecord);
+    int maxSmpPerRecord = 0;
+    for (const auto& ch : sourceData.channels) maxSmpPerRecord = std::max(maxSmpPerRecord, ch.smp_in_datarecord);
+    std::vector<double> writeBuffer(maxSmpPerRecord);
 
     for (long long r = 0; r < numRecords; ++r) {
         for (int s = 0; s < channelCount; ++s) {
-            size_t channelStartIdx = (size_t)s * sourceData.samplesPerSignalPadded + sourceData.padding;
+            size_t channelStartIdx = sourceData.channelStarts[s] + sourceData.padding;
             size_t currentOffset = channelStartIdx + (r * sourceData.channels[s].smp_in_datarecord);
 
             for(int k = 0; k < sourceData.channels[s].smp_in_datarecord; ++k) {
@@ -111,3 +124,196 @@ void save_data(const NeonVector& processedData, const std::string& filepath, con
     
     edfclose_file(handle);
 }
+
+// Helper to append a space-padded fixed-width ASCII field to an EDF header.
+void append_header_field(std::string& header, const std::string& value, size_t width) {
+    std::string field = value.substr(0, width);
+    field.resize(width, ' ');
+    header += field;
+}
+
+// Helper to format a number for an 8-character EDF header field (drops precision until it fits).
+std::string format_header_number(double value) {
+    char buffer[32];
+    for (int precision = 8; precision > 0; --precision) {
+        snprintf(buffer, sizeof(buffer), "%.*g", precision, value);
+        if (strlen(buffer) <= 8) break;
+    }
+    return buffer;
+}
+
+/**
+ * Builds the header of a plain EDF file holding the (data) signals of the source in recordCount records.
+ *
+ * @param sourceData Original EdfData structure to copy metadata from.
+ * @param recordCount Number of data records in the file.
+ */
+std::string build_edf_header(const EdfData& sourceData, const long long recordCount) {
+    const int channelCount = sourceData.header.num_signals;
+    if (channelCount < 1) {
+        throw std::runtime_error("Error: No channels to save.");
+    }
+
+    const auto& hdr = sourceData.header;
+    char date[16];
+    char time[16];
+    snprintf(date, sizeof(date), "%02d.%02d.%02d", hdr.startdate_day, hdr.startdate_month, hdr.startdate_year % 100);
+    // Plain EDF stores whole seconds, starttime_subsecond is dropped (only EDF+ / BDF+ can hold it).
+    snprintf(time, sizeof(time), "%02d.%02d.%02d", hdr.starttime_hour, hdr.starttime_minute, hdr.starttime_second);
+
+    std::string header;
+    header.reserve(256 * (channelCount + 1));
+    append_header_field(header, "0", 8);
+    append_header_field(header, hdr.patient, 80);
+    append_header_field(header, hdr.recording, 80);
+    append_header_field(header, date, 8);
+    append_header_field(header, time, 8);
+    append_header_field(header, std::to_string(256 * (channelCount + 1)), 8);
+    append_header_field(header, "", 44);
+    append_header_field(header, std::to_string(recordCount), 8);
+    append_header_field(header, format_header_number(hdr.data_record_duration / 10000000.0), 8);
+    append_header_field(header, std::to_string(channelCount), 4);
+
+    // Signal fields are stored field by field for all channels.
+    for (const auto& ch : sourceData.channels) append_header_field(header, ch.label, 16);
+    for (const auto& ch : sourceData.channels) append_header_field(header, ch.transducer, 80);
+    for (const auto& ch : sourceData.channels) append_header_field(header, ch.dimension, 8);
+    for (const auto& ch : sourceData.channels) append_header_field(header, format_header_number(ch.phys_min), 8);
+    for (const auto& ch : sourceData.channels) append_header_field(header, format_header_number(ch.phys_max), 8);
+    for (const auto& ch : sourceData.channels) append_header_field(header, std::to_string(ch.dig_min), 8);
+    for (const auto& ch : sourceData.channels) append_header_field(header, std::to_string(ch.dig_max), 8);
+    for (int i = 0; i < channelCount; ++i) append_header_field(header, "Linear Convolution Filter", 80);
+    for (const auto& ch : sourceData.channels) append_header_field(header, std::to_string(ch.smp_in_datarecord), 8);
+    for (int i = 0; i < channelCount; ++i) append_header_field(header, "", 32);
+    return header;
+}
+
+/**
+ * Creates the output EDF file with its final size (header + all records), writes the header and maps the file,
+ * so the output stage quantizes the records directly into the page cache of the file (no record buffer,
+ * no serial write at the end). Complete the file with finish_mapped_records.
+ *
+ * @param sourceData Source EDF data.
+ * @param kernelSize Size of the convolution kernel.
+ * @param filepath Output file path.
+ */
+EdfRecordOutput create_mapped_record_output(const EdfData& sourceData, const size_t kernelSize, const std::string& filepath) {
+    std::filesystem::path pathObj(filepath);
+    std::filesystem::path dirPath = pathObj.parent_path();
+    if (!dirPath.empty() && !std::filesystem::exists(dirPath)) {
+        std::filesystem::create_directories(dirPath);
+    }
+
+    EdfRecordOutput records = record_output_layout(sourceData, kernelSize);
+    const std::string header = build_edf_header(sourceData, records.layout.recordCount);
+
+    records.file = std::make_shared<MappedOutputFile>(filepath, header.size() + records.size() * sizeof(int16_t));
+    std::memcpy(records.file->data, header.data(), header.size());
+    // The header is 256 * (signals + 1) bytes, so the records stay 2-byte aligned.
+    records.mappedRecords = reinterpret_cast<int16_t*>(records.file->data + header.size());
+    return records;
+}
+
+/**
+ * Completes a file created by create_mapped_record_output: optionally flushes it to the storage device
+ * (MAPPED_OUTPUT_SYNC) and unmaps it.
+ */
+void finish_mapped_records(EdfRecordOutput& records) {
+    if (!records.file) return;
+
+    if (MAPPED_OUTPUT_SYNC) {
+        const auto syncStart = std::chrono::high_resolution_clock::now();
+        records.file->sync();
+        std::cout << "Synced EDF output: " << std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - syncStart).count() << "s" << std::endl;
+    }
+    records.mappedRecords = nullptr;
+    records.file.reset();
+}
+
+/**
+ * Saves records quantized by the output stage to a new (plain) EDF file.
+ * The records already have the EDF data layout, so the header is written first and the record buffer
+ * follows in IO_BLOCK_BYTES blocks, IO_QUEUE_DEPTH of them in flight.
+ *
+ * @param records Quantized output in EDF data-record layout.
+ * @param filepath Output file path.
+ * @param sourceData Original EdfData structure to copy metadata from.
+ */
+void save_records(const EdfRecordOutput& records, const std::string& filepath, const EdfData& sourceData) {
+    std::cout << "Exporting EDF records: " << filepath << "..." << std::endl;
+
+    std::filesystem::path pathObj(filepath);
+    std::filesystem::path dirPath = pathObj.parent_path();
+    if (!dirPath.empty() && !std::filesystem::exists(dirPath)) {
+        std::filesystem::create_directories(dirPath);
+    }
+
+    const std::string header = build_edf_header(sourceData, records.layout.recordCount);
+
+    FileDescriptorGuard file(open(filepath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644));
+    if (file.fd < 0) {
+        throw std::runtime_error("Error: Could not open file for writing: " + filepath);
+    }
+
+    try {
+        write_at(file.fd, reinterpret_cast<const uint8_t*>(header.data()), header.size(), 0);
+        pipelined_write(file.fd, reinterpret_cast<const uint8_t*>(records.data()), records.size() * sizeof(int16_t), static_cast<off_t>(header.size()));
+    } catch (const std::runtime_error&) {
+        throw std::runtime_error("Error: Writing EDF records failed: " + filepath);
+    }
+}
+
+/**
+ * Creates a plain EDF file without data records, to be extended by append_edf_records (follow mode).
+ *
+ * @param filepath Output file path.
+ * @param sourceData EdfData structure to copy metadata from.
+ */
+void create_growing_edf(const std::string& filepath, const EdfData& sourceData) {
+    std::filesystem::path pathObj(filepath);
+    std::filesystem::path dirPath = pathObj.parent_path();
+    if (!dirPath.empty() && !std::filesystem::exists(dirPath)) {
+        std::filesystem::create_directories(dirPath);
+    }
+
+    const std::string header = build_edf_header(sourceData, 0);
+
+    FileDescriptorGuard file(open(filepath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644));
+    if (file.fd < 0) {
+        throw std::runtime_error("Error: Could not open file for writing: " + filepath);
+    }
+    write_at(file.fd, reinterpret_cast<const uint8_t*>(header.data()), header.size(), 0);
+}
+
+/**
+ * Appends records to an EDF file created by create_growing_edf. The records are written first and the record
+ * count in the header afterwards, so readers never see a count that covers missing records.
+ *
+ * @param records Quantized output in EDF data-record layout (the layout of the file).
+ * @param filepath Output file path.
+ * @return Number of data records in the file.
+ */
+long long append_edf_records(const EdfRecordOutput& records, const std::string& filepath) {
+    FileDescriptorGuard file(open(filepath.c_str(), O_RDWR));
+    if (file.fd < 0) {
+        throw std::runtime_error("Error: Could not open file for writing: " + filepath);
+    }
+
+    char header[257] = {};
+    read_at(file.fd, reinterpret_cast<uint8_t*>(header), 256, 0);
+    const size_t headerSize = std::strtoull(std::string(header + 184, 8).c_str(), nullptr, 10);
+    const long long recordCount = std::strtoll(std::string(header + 236, 8).c_str(), nullptr, 10);
+    const size_t bytesPerRecord = records.layout.recordSize * sizeof(int16_t);
+
+    try {
+        write_at(file.fd, reinterpret_cast<const uint8_t*>(records.data()), records.size() * sizeof(int16_t),
+                 static_cast<off_t>(headerSize + static_cast<size_t>(recordCount) * bytesPerRecord));
+
+        std::string countField;
+        append_header_field(countField, std::to_string(recordCount + records.layout.recordCount), 8);
+        write_at(file.fd, reinterpret_cast<const uint8_t*>(countField.data()), countField.size(), 236);
+    } catch (const std::runtime_error&) {
+        throw std::runtime_error("Error: Appending EDF records failed: " + filepath);
+    }
+    return recordCount + records.layout.recordCount;
+}
@@ -0,0 +1,130 @@
+//
+//  edf_reader.cpp
+//  EegLinearFilter
+//
+//  Implementation of the random-access EDF / BDF reader.
+//
+
+#include "edf_reader.hpp"
+#include "io.hpp"
+#include <dispatch/dispatch.h>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <sys/stat.h>
+
+// Helper to fill one padded window: decode(first, count, dst) reads the part inside the recording,
+// the padding outside the recording repeats the first / last sample.
+template <typename T, typename Decode>
+void fill_padded_window(T* out, const size_t start, const size_t count, const size_t padding, const size_t length, const Decode& decode) {
+    const size_t first = (start >= padding) ? start - padding : 0;
+    const size_t end = std::min(start + count + padding, length);
+    const size_t lead = first + padding - start;
+
+    decode(first, end - first, out + lead);
+    std::fill_n(out, lead, out[lead]);
+    std::fill(out + lead + (end - first), out + count + 2 * padding, out[lead + (end - first) - 1]);
+}
+
+EdfReader::EdfReader(const std::string& filePath, const bool growing)
+    : data(growing ? read_growing_edf_metadata(filePath.c_str()) : read_edf_metadata(filePath.c_str())),
+      file(std::make_unique<MappedFile>(filePath)) {}
+
+long long EdfReader::refresh() {
+    struct stat st;
+    if (stat(data.records.filePath.c_str(), &st) != 0) {
+        throw std::runtime_error("Cannot determine file size: " + data.records.filePath);
+    }
+
+    const size_t bytesPerRecord = data.records.recordSize * data.records.bytesPerSample;
+    // A file truncated below its header (e.g. rewritten by the recorder) has no complete records.
+    const size_t fileSize = static_cast<size_t>(st.st_size);
+    const long long recordCount = (fileSize < data.records.headerSize) ? 0 : static_cast<long long>((fileSize - data.records.headerSize) / bytesPerRecord);
+    const long long newRecords = recordCount - data.records.recordCount;
+    if (newRecords <= 0) return 0;
+
+    // The old mapping ends at the old file size, the appended records need a new one.
+    file = std::make_unique<MappedFile>(data.records.filePath);
+    data.records.recordCount = recordCount;
+    data.totalSamplesPadded = 0;
+    for (size_t c = 0; c < data.channels.size(); ++c) {
+        const long long length = recordCount * data.channels[c].smp_in_datarecord;
+        if (length > std::numeric_limits<int>::max()) throw std::runtime_error("Sample count too high");
+
+        data.channelStarts[c] = data.totalSamplesPadded;
+        data.channelLengths[c] = static_cast<int>(length);
+        data.totalSamplesPadded += static_cast<size_t>(length);
+    }
+    return newRecords;
+}
+
+int EdfReader::find_channel(const std::string& label) const {
+    for (size_t c = 0; c < data.channels.size(); ++c) {
+        if (data.channels[c].label == label) return static_cast<int>(c);
+    }
+    return -1;
+}
+
+void EdfReader::check_window(const std::vector<int>& channels, const size_t start, const size_t count) const {
+    if (count == 0) {
+        throw std::runtime_error("Window must contain at least one sample");
+    }
+    for (const int c : channels) {
+        if (c < 0 || c >= channel_count()) {
+            throw std::runtime_error("Channel index out of range: " + std::to_string(c));
+        }
+        if (start + count > channel_length(c)) {
+            throw std::runtime_error("Window exceeds the recording of channel " + data.channels[c].label);
+        }
+    }
+}
+
+void EdfReader::read(const std::vector<int>& channels, const size_t start, const size_t count, float* dst, const size_t padding) const {
+    check_window(channels, start, count);
+
+    const EdfData* dataPtr = &data;
+    const uint8_t* fileData = file->data;
+    const int* channelsPtr = channels.data();
+
+    dispatch_apply(channels.size(), dispatch_get_global_queue(QOS_CLASS_USER_INTERACTIVE, 0), ^(size_t i) {
+        const int c = channelsPtr[i];
+        const ChannelInfo info = channel_info(dataPtr->channels[c]);
+
+        fill_padded_window(dst + i * (count + 2 * padding), start, count, padding, static_cast<size_t>(dataPtr->channelLengths[c]),
+            [&](const size_t first, const size_t n, float* out) {
+                decode_channel_range(fileData, dataPtr->records, c, info.smpInRecord, first, n, out, info.scale, info.offset);
+            });
+    });
+}
+
+void EdfReader::read_digital(const std::vector<int>& channels, const size_t start, const size_t count, int16_t* dst, const size_t padding) const {
+    if (data.records.bytesPerSample != sizeof(int16_t)) {
+        throw std::runtime_error("Digital reads require 16-bit EDF samples (BDF stores 24-bit samples)");
+    }
+    check_window(channels, start, count);
+
+    const EdfData* dataPtr = &data;
+    const int16_t* records = reinterpret_cast<const int16_t*>(file->data + data.records.headerSize);
+    const int* channelsPtr = channels.data();
+
+    dispatch_apply(channels.size(), dispatch_get_global_queue(QOS_CLASS_USER_INTERACTIVE, 0), ^(size_t i) {
+        const int c = channelsPtr[i];
+        const size_t spr = static_cast<size_t>(dataPtr->channels[c].smp_in_datarecord);
+        const EdfRecordLayout& layout = dataPtr->records;
+
+        fill_padded_window(dst + i * (count + 2 * padding), start, count, padding, static_cast<size_t>(dataPtr->channelLengths[c]),
+            [&](size_t first, size_t n, int16_t* out) {
+                // Contiguous runs within single records (as decode_channel_range).
+                while (n > 0) {
+                    const size_t inRecord = first % spr;
+                    const size_t run = std::min(n, spr - inRecord);
+                    std::memcpy(out, records + (first / spr) * layout.recordSize + layout.channelOffsets[c] + inRecord, run * sizeof(int16_t));
+
+                    out += run;
+                    first += run;
+                    n -= run;
+                }
+            });
+    });
+}
@@ -0,0 +1,70 @@
+//
+//  edf_reader.hpp
+//  EegLinearFilter
+//
+//  Random-access reader serving windows of single channels straight from the mapped EDF / BDF data records.
+//
+
+#ifndef EDF_READER_HPP
+#define EDF_READER_HPP
+
+#include "../data_types.hpp"
+#include "edf_records.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Random-access reader for windowed reads of long recordings.
+ * The header is parsed once; afterwards the position of every sample is known (record = sample / samples per record),
+ * so a window is decoded straight from the mapped data records and only its pages are read from the file.
+ */
+class EdfReader {
+public:
+    // With growing set, the file may still be written (live recording, see read_growing_edf_metadata and refresh).
+    explicit EdfReader(const std::string& filePath, bool growing = false);
+
+    // Header, channel parameters and record layout (channelLengths hold the samples of every channel, no samples are loaded).
+    const EdfData& metadata() const { return data; }
+
+    int channel_count() const { return static_cast<int>(data.channels.size()); }
+    size_t channel_length(const int channel) const { return static_cast<size_t>(data.channelLengths[channel]); }
+
+    /**
+     * Picks up the data records appended since the file was mapped (a record still being written is left for later).
+     * Channel lengths grow accordingly.
+     *
+     * @return Number of new data records.
+     */
+    long long refresh();
+
+    // Index of the channel with the given label, -1 if there is none.
+    int find_channel(const std::string& label) const;
+
+    /**
+     * Decodes samples [start, start + count) of every listed channel into dst (physical values), channel after
+     * channel, each block surrounded by padding samples (count + 2 * padding per channel, the EdfData layout).
+     * Padding samples come from the file where the recording continues and repeat the first / last sample at its
+     * borders, so filtering the window gives the same outputs as filtering the whole recording.
+     * Channels are decoded in parallel. Sample indices are per channel (channels may have different rates).
+     *
+     * @param dst Caller-provided buffer of channels.size() * (count + 2 * padding) floats.
+     * @throws std::runtime_error if a channel does not exist or the window exceeds a channel.
+     */
+    void read(const std::vector<int>& channels, size_t start, size_t count, float* dst, size_t padding = 0) const;
+
+    /**
+     * Same as read, but copies the raw int16 digital samples (16-bit EDF files only).
+     *
+     * @throws std::runtime_error additionally for 24-bit (BDF) files.
+     */
+    void read_digital(const std::vector<int>& channels, size_t start, size_t count, int16_t* dst, size_t padding = 0) const;
+
+private:
+    void check_window(const std::vector<int>& channels, size_t start, size_t count) const;
+
+    EdfData data;
+    std::unique_ptr<MappedFile> file;
+};
+
+#endif // EDF_READER_HPP
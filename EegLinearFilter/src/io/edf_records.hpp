@@ -0,0 +1,363 @@
+//
+//  edf_records.hpp
+//  EegLinearFilter
+//
+//  Helpers for direct access to EDF data records (memory mapping, int16 / 24-bit <-> float conversion).
+//
+
+#ifndef EDF_RECORDS_HPP
+#define EDF_RECORDS_HPP
+
+#include "../data_types.hpp"
+#include <arm_neon.h>
+#include <dispatch/dispatch.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+/**
+ * RAII read-only memory mapping of a whole file.
+ */
+struct MappedFile {
+    int fd = -1;
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+
+    explicit MappedFile(const std::string& filePath) {
+        fd = open(filePath.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open file for mapping: " + filePath);
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+            close(fd);
+            throw std::runtime_error("Cannot determine file size: " + filePath);
+        }
+        size = static_cast<size_t>(st.st_size);
+
+        void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error("Cannot map file: " + filePath);
+        }
+        data = static_cast<const uint8_t*>(mapped);
+    }
+
+    ~MappedFile() {
+        if (data) munmap(const_cast<uint8_t*>(data), size);
+        if (fd >= 0) close(fd);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+};
+
+/**
+ * RAII shared read-write mapping of a new output file of known size. The file is preallocated before it is
+ * mapped, so stores into the mapping cannot fail later for lack of disk space.
+ */
+struct MappedOutputFile {
+    int fd = -1;
+    uint8_t* data = nullptr;
+    size_t size = 0;
+
+    MappedOutputFile(const std::string& filePath, const size_t bytes) : size(bytes) {
+        fd = open(filePath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open file for writing: " + filePath);
+        }
+
+#if defined(F_PREALLOCATE)
+        fstore_t store = {F_ALLOCATECONTIG | F_ALLOCATEALL, F_PEOFPOSMODE, 0, static_cast<off_t>(bytes), 0};
+        if (fcntl(fd, F_PREALLOCATE, &store) == -1) {
+            store.fst_flags = F_ALLOCATEALL;
+            if (fcntl(fd, F_PREALLOCATE, &store) == -1 && errno == ENOSPC) {
+                close(fd);
+                throw std::runtime_error("Not enough disk space for: " + filePath);
+            }
+        }
+#else
+        if (posix_fallocate(fd, 0, static_cast<off_t>(bytes)) == ENOSPC) {
+            close(fd);
+            throw std::runtime_error("Not enough disk space for: " + filePath);
+        }
+#endif
+        if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+            close(fd);
+            throw std::runtime_error("Cannot resize file: " + filePath);
+        }
+
+        void* mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (mapped == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error("Cannot map file: " + filePath);
+        }
+        data = static_cast<uint8_t*>(mapped);
+    }
+
+    // Flushes the mapping to the file and the file to the storage device.
+    void sync() const {
+        if (msync(data, size, MS_SYNC) != 0 || fsync(fd) != 0) {
+            throw std::runtime_error("Syncing the output file failed");
+        }
+    }
+
+    ~MappedOutputFile() {
+        if (data) munmap(data, size);
+        if (fd >= 0) close(fd);
+    }
+
+    MappedOutputFile(const MappedOutputFile&) = delete;
+    MappedOutputFile& operator=(const MappedOutputFile&) = delete;
+};
+
+/**
+ * Float32 digital -> physical mapping of one channel, as used by the decoders.
+ */
+struct ChannelInfo {
+    int smpInRecord;
+    float scale;
+    float offset;
+};
+
+inline ChannelInfo channel_info(const EdfChannelParams& channel) {
+    ChannelInfo info;
+    info.smpInRecord = channel.smp_in_datarecord;
+    info.scale = static_cast<float>(channel.scale);
+    info.offset = (channel.dig_max == channel.dig_min) ? 0.0f : static_cast<float>(channel.phys_min - (channel.dig_min * info.scale));
+    return info;
+}
+
+/**
+ * Converts raw digital samples to physical values (physical = digital * scale + offset).
+ * The int16 -> float conversion happens in Neon registers (widen, convert, fused multiply-add).
+ */
+inline void decode_digital_samples(const int16_t* __restrict src, float* __restrict dst, const size_t count, const float scale, const float offset) {
+    const float32x4_t offsetVec = vdupq_n_f32(offset);
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        const int16x8_t v = vld1q_s16(src + i);
+        const float32x4_t lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(v)));
+        const float32x4_t hi = vcvtq_f32_s32(vmovl_high_s16(v));
+        vst1q_f32(dst + i, vfmaq_n_f32(offsetVec, lo, scale));
+        vst1q_f32(dst + i + 4, vfmaq_n_f32(offsetVec, hi, scale));
+    }
+
+    for (; i < count; ++i) dst[i] = static_cast<float>(src[i]) * scale + offset;
+}
+
+/**
+ * Converts raw 24-bit little-endian BDF samples to physical values (physical = digital * scale + offset).
+ * 16 samples (48 bytes) are loaded per step; a table lookup moves the 3 bytes of every sample into the upper
+ * 3 bytes of a 32-bit lane and the arithmetic shift right by 8 sign-extends it. No byte-wise loop on the fast path.
+ */
+inline void decode_bdf_samples(const uint8_t* __restrict src, float* __restrict dst, const size_t count, const float scale, const float offset) {
+    // Index 0xFF is out of table range and yields 0 (the low byte of the lane).
+    static const uint8_t unpackIndices[4][16] = {
+        {0xFF,  0,  1,  2, 0xFF,  3,  4,  5, 0xFF,  6,  7,  8, 0xFF,  9, 10, 11},
+        {0xFF, 12, 13, 14, 0xFF, 15, 16, 17, 0xFF, 18, 19, 20, 0xFF, 21, 22, 23},
+        {0xFF, 24, 25, 26, 0xFF, 27, 28, 29, 0xFF, 30, 31, 32, 0xFF, 33, 34, 35},
+        {0xFF, 36, 37, 38, 0xFF, 39, 40, 41, 0xFF, 42, 43, 44, 0xFF, 45, 46, 47}
+    };
+    const uint8x16_t idx0 = vld1q_u8(unpackIndices[0]);
+    const uint8x16_t idx1 = vld1q_u8(unpackIndices[1]);
+    const uint8x16_t idx2 = vld1q_u8(unpackIndices[2]);
+    const uint8x16_t idx3 = vld1q_u8(unpackIndices[3]);
+    const float32x4_t offsetVec = vdupq_n_f32(offset);
+    size_t i = 0;
+
+    for (; i + 16 <= count; i += 16) {
+        const uint8x16x3_t bytes = vld1q_u8_x3(src + 3 * i);
+        const int32x4_t v0 = vshrq_n_s32(vreinterpretq_s32_u8(vqtbl3q_u8(bytes, idx0)), 8);
+        const int32x4_t v1 = vshrq_n_s32(vreinterpretq_s32_u8(vqtbl3q_u8(bytes, idx1)), 8);
+        const int32x4_t v2 = vshrq_n_s32(vreinterpretq_s32_u8(vqtbl3q_u8(bytes, idx2)), 8);
+        const int32x4_t v3 = vshrq_n_s32(vreinterpretq_s32_u8(vqtbl3q_u8(bytes, idx3)), 8);
+        vst1q_f32(dst + i, vfmaq_n_f32(offsetVec, vcvtq_f32_s32(v0), scale));
+        vst1q_f32(dst + i + 4, vfmaq_n_f32(offsetVec, vcvtq_f32_s32(v1), scale));
+        vst1q_f32(dst + i + 8, vfmaq_n_f32(offsetVec, vcvtq_f32_s32(v2), scale));
+        vst1q_f32(dst + i + 12, vfmaq_n_f32(offsetVec, vcvtq_f32_s32(v3), scale));
+    }
+
+    for (; i < count; ++i) {
+        const uint8_t* p = src + 3 * i;
+        const int32_t value = static_cast<int32_t>(static_cast<uint32_t>(p[0]) << 8 | static_cast<uint32_t>(p[1]) << 16 | static_cast<uint32_t>(p[2]) << 24) >> 8;
+        dst[i] = static_cast<float>(value) * scale + offset;
+    }
+}
+
+/**
+ * Decodes samples [first, first + count) of one channel straight from the mapped data records.
+ * The channel's samples are interleaved with the other channels record by record, so the range
+ * is split into contiguous runs within single records. Handles 16-bit (EDF) and 24-bit (BDF) records.
+ *
+ * @param fileData Start of the mapped EDF file.
+ * @param layout Record layout of the file.
+ * @param channel Channel index.
+ * @param samplesInRecord Samples of the channel in one data record.
+ */
+inline void decode_channel_range(const uint8_t* fileData, const EdfRecordLayout& layout, const int channel, const int samplesInRecord, size_t first, size_t count, float* __restrict dst, const float scale, const float offset) {
+    const uint8_t* records = fileData + layout.headerSize;
+    const size_t spr = static_cast<size_t>(samplesInRecord);
+
+    while (count > 0) {
+        const size_t record = first / spr;
+        const size_t inRecord = first % spr;
+        const size_t run = std::min(count, spr - inRecord);
+
+        const uint8_t* src = records + (record * layout.recordSize + layout.channelOffsets[channel] + inRecord) * layout.bytesPerSample;
+        if (layout.bytesPerSample == 3) {
+            decode_bdf_samples(src, dst, run, scale, offset);
+        } else {
+            decode_digital_samples(reinterpret_cast<const int16_t*>(src), dst, run, scale, offset);
+        }
+
+        dst += run;
+        first += run;
+        count -= run;
+    }
+}
+
+/**
+ * Converts physical values to the channel's digital range (digital = round((physical - offset) / scale), saturated).
+ */
+inline void encode_digital_samples(const float* __restrict src, int16_t* __restrict dst, const size_t count, const float scale, const float offset, const int16_t digMin, const int16_t digMax) {
+    const float invScale = 1.0f / scale;
+    const float32x4_t offsetVec = vdupq_n_f32(offset);
+    const int16x8_t minVec = vdupq_n_s16(digMin);
+    const int16x8_t maxVec = vdupq_n_s16(digMax);
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        const int32x4_t lo = vcvtnq_s32_f32(vmulq_n_f32(vsubq_f32(vld1q_f32(src + i), offsetVec), invScale));
+        const int32x4_t hi = vcvtnq_s32_f32(vmulq_n_f32(vsubq_f32(vld1q_f32(src + i + 4), offsetVec), invScale));
+        const int16x8_t packed = vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi));
+        vst1q_s16(dst + i, vminq_s16(vmaxq_s16(packed, minVec), maxVec));
+    }
+
+    for (; i < count; ++i) {
+        const long value = std::lround((src[i] - offset) * invScale);
+        dst[i] = static_cast<int16_t>(std::clamp<long>(value, digMin, digMax));
+    }
+}
+
+/**
+ * Quantizes samples [first, first + count) of one channel straight into the record buffer
+ * (inverse of decode_channel_range).
+ */
+inline void encode_channel_range(const float* __restrict src, EdfRecordOutput& output, const int channel, const EdfChannelParams& params, size_t first, size_t count) {
+    const size_t spr = static_cast<size_t>(params.smp_in_datarecord);
+    const float scale = static_cast<float>(params.scale);
+    const float offset = static_cast<float>(params.offset);
+    const int16_t digMin = static_cast<int16_t>(std::max(params.dig_min, -32768));
+    const int16_t digMax = static_cast<int16_t>(std::min(params.dig_max, 32767));
+
+    while (count > 0) {
+        const size_t record = first / spr;
+        const size_t inRecord = first % spr;
+        const size_t run = std::min(count, spr - inRecord);
+
+        int16_t* dst = output.data() + record * output.layout.recordSize + output.layout.channelOffsets[channel] + inRecord;
+        encode_digital_samples(src, dst, run, scale, offset, digMin, digMax);
+
+        src += run;
+        first += run;
+        count -= run;
+    }
+}
+
+/**
+ * Emits one filtered tile of a channel into the record buffer. Tile output j (channel-local output index)
+ * is stored at record position j - padding, the same mapping save_data uses; positions outside the records are dropped.
+ *
+ * @param tile Filtered values of outputs [start, start + count).
+ */
+inline void emit_tile_to_records(const float* tile, const size_t start, const size_t count, const int channel, const EdfData& data, EdfRecordOutput& output) {
+    const long long positions = output.layout.recordCount * data.channels[channel].smp_in_datarecord;
+    const long long first = std::max(static_cast<long long>(start) - data.padding, 0LL);
+    const long long end = std::min(static_cast<long long>(start + count) - data.padding, positions);
+
+    if (end > first) {
+        encode_channel_range(tile + (first + data.padding - static_cast<long long>(start)), output, channel, data.channels[channel], static_cast<size_t>(first), static_cast<size_t>(end - first));
+    }
+}
+
+/**
+ * Number of whole data records covered by the valid (non-border) outputs of every channel.
+ * Channels of different sampling rates have different lengths but the same duration, so the shortest
+ * channel in records (its valid length / its samples per record) sets the count.
+ *
+ * @param data Source EDF data.
+ * @param kernelSize Size of the convolution kernel.
+ */
+inline long long valid_record_count(const EdfData& data, const size_t kernelSize) {
+    long long recordCount = std::numeric_limits<long long>::max();
+    for (size_t c = 0; c < data.channels.size(); ++c) {
+        const long long validSamples = std::max(static_cast<long long>(data.channelLengths[c]) - static_cast<long long>(kernelSize - 1), 0LL);
+        recordCount = std::min(recordCount, validSamples / data.channels[c].smp_in_datarecord);
+    }
+    return data.channels.empty() ? 0 : recordCount;
+}
+
+/**
+ * Record layout of the filtered recording (without storage). The number of records matches save_data
+ * (only whole records of valid, non-border outputs).
+ *
+ * @param data Source EDF data.
+ * @param kernelSize Size of the convolution kernel.
+ */
+inline EdfRecordOutput record_output_layout(const EdfData& data, const size_t kernelSize) {
+    EdfRecordOutput output;
+    output.layout.headerSize = 0;
+    output.layout.bytesPerSample = sizeof(int16_t);
+    // The output records hold the data signals only (annotation signals of the source are not written).
+    output.layout.recordSize = 0;
+    for (const auto& ch : data.channels) {
+        output.layout.channelOffsets.push_back(output.layout.recordSize);
+        output.layout.recordSize += ch.smp_in_datarecord;
+    }
+
+    output.layout.recordCount = valid_record_count(data, kernelSize);
+    return output;
+}
+
+/**
+ * Allocates the record buffer for the filtered recording (see record_output_layout).
+ */
+inline EdfRecordOutput create_record_output(const EdfData& data, const size_t kernelSize) {
+    EdfRecordOutput output = record_output_layout(data, kernelSize);
+    output.samples.resize(output.size());
+    return output;
+}
+
+/**
+ * Quantizes a finished float output buffer into the record buffer (one GCD task per channel chunk, balanced by samples).
+ * Used by the modes without a fused output stage.
+ *
+ * @tparam ChunkSize Outputs per GCD task.
+ */
+template <int ChunkSize>
+void quantize_output_records(const EdfData& data, const NeonVector& outputBuffer, EdfRecordOutput& output) {
+    const std::vector<ChannelChunk> chunks = split_channel_chunks(data, 2 * static_cast<size_t>(data.padding) + 1, ChunkSize);
+
+    const EdfData* dataPtr = &data;
+    const float* outputPtr = outputBuffer.data();
+    const ChannelChunk* chunksPtr = chunks.data();
+    EdfRecordOutput* recordsPtr = &output;
+
+    dispatch_apply(chunks.size(), dispatch_get_global_queue(QOS_CLASS_USER_INTERACTIVE, 0), ^(size_t taskIndex) {
+        const ChannelChunk& chunk = chunksPtr[taskIndex];
+        emit_tile_to_records(outputPtr + dataPtr->channelStarts[chunk.channel] + chunk.start, chunk.start, chunk.count, chunk.channel, *dataPtr, *recordsPtr);
+    });
+}
+
+#endif // EDF_RECORDS_HPP
@@ -0,0 +1,92 @@
+//
+//  file_watch.hpp
+//  EegLinearFilter
+//
+//  Waits for writes to a file (inotify on Linux, kqueue on macOS, plain interval polling elsewhere).
+//
+
+#ifndef FILE_WATCH_HPP
+#define FILE_WATCH_HPP
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#elif defined(__APPLE__)
+#include <sys/event.h>
+#include <sys/time.h>
+#endif
+
+/**
+ * Watch of a single file that is appended to by another process.
+ * wait returns as soon as the file is written, or after the timeout at the latest, so the caller re-checks the
+ * file size either way (events may be coalesced or missed, e.g. on network file systems).
+ */
+class FileWatch {
+public:
+    explicit FileWatch(const std::string& filePath) {
+#if defined(__linux__)
+        queue = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (queue >= 0 && inotify_add_watch(queue, filePath.c_str(), IN_MODIFY | IN_CLOSE_WRITE) < 0) {
+            close(queue);
+            queue = -1;
+        }
+#elif defined(__APPLE__)
+        file = open(filePath.c_str(), O_EVTONLY);
+        queue = (file >= 0) ? kqueue() : -1;
+        if (queue >= 0) {
+            struct kevent change;
+            EV_SET(&change, file, EVFILT_VNODE, EV_ADD | EV_CLEAR, NOTE_WRITE | NOTE_EXTEND, 0, nullptr);
+            if (kevent(queue, &change, 1, nullptr, 0, nullptr) < 0) {
+                close(queue);
+                queue = -1;
+            }
+        }
+#endif
+    }
+
+    ~FileWatch() {
+        if (queue >= 0) close(queue);
+        if (file >= 0) close(file);
+    }
+
+    FileWatch(const FileWatch&) = delete;
+    FileWatch& operator=(const FileWatch&) = delete;
+
+    // Whether writes are reported by the OS (otherwise wait always sleeps for the whole timeout).
+    bool has_events() const { return queue >= 0; }
+
+    // Blocks until the file is written or timeoutMs have passed.
+    void wait(const int timeoutMs) const {
+#if defined(__linux__)
+        if (queue >= 0) {
+            pollfd request = {queue, POLLIN, 0};
+            if (poll(&request, 1, timeoutMs) > 0) {
+                // Drain the queued events, one wake-up covers all writes so far.
+                alignas(inotify_event) char events[4096];
+                while (read(queue, events, sizeof(events)) > 0) {}
+            }
+            return;
+        }
+#elif defined(__APPLE__)
+        if (queue >= 0) {
+            const timespec timeout = {timeoutMs / 1000, (timeoutMs % 1000) * 1000000L};
+            struct kevent event;
+            kevent(queue, nullptr, 0, &event, 1, &timeout);
+            return;
+        }
+#endif
+        std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+    }
+
+private:
+    int queue = -1;
+    int file = -1;  // Descriptor kept open for the kqueue watch.
+};
+
+#endif // FILE_WATCH_HPP
@@ -9,15 +9,31 @@
 #ifndef IO_HPP
 #define IO_HPP
 
+#include <mutex>
 #include <string>
 #include "../config.h"
 #include "../data_types.hpp"
 #include "../../lib/edflib/edflib.h"
 
+std::mutex& edflib_mutex();
 AppConfig read_user_input();
 bool ask_to_continue();
 bool download_file(const std::string& url, const std::string& filepath);
-EdfData load_edf_data(const char* filePath, const int padding = 0);
+std::vector<std::string> read_channel_labels(const char* filePath);
+EdfData read_edf_metadata(const char* filePath);
+EdfData read_growing_edf_metadata(const char* filePath);
+void narrow_half_samples(EdfData& data, const bool keepPhysical);
+EdfData load_edf_data(const char* filePath, const int padding = 0, const SampleFormat format = SampleFormat::FLOAT32, const LoadSelection& selection = {});
+bool load_sample_cache(const char* filePath, const int padding, const SampleFormat format, const LoadSelection& selection, EdfData& data);
+void save_sample_cache(const char* filePath, const int padding, const SampleFormat format, const LoadSelection& selection, const EdfData& data);
 void save_data(const NeonVector& data, const std::string& filepath, const std::vector<float>& convolutionKernel, const EdfData& sourceData);
+EdfRecordOutput create_mapped_record_output(const EdfData& sourceData, const size_t kernelSize, const std::string& filepath);
+void finish_mapped_records(EdfRecordOutput& records);
+void save_records(const EdfRecordOutput& records, const std::string& filepath, const EdfData& sourceData);
+void create_growing_edf(const std::string& filepath, const EdfData& sourceData);
+long long append_edf_records(const EdfRecordOutput& records, const std::string& filepath);
+void save_columnar(const NeonVector& data, const std::string& filepath, const std::vector<float>& convolutionKernel, const EdfData& sourceData);
+void save_columnar_records(const EdfRecordOutput& records, const std::string& filepath, const EdfData& sourceData);
+std::vector<float> read_columnar_samples(const std::string& filepath, const int channel, const size_t firstSample, const size_t count);
 
 #endif // IO_HPP
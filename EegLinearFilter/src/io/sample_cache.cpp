@@ -0,0 +1,328 @@
+//
+//  sample_cache.cpp
+//  EegLinearFilter
+//
+//  Sidecar cache of the decoded samples, read with pread into the pooled sample buffers by later loads.
+//
+
+#include "io.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+
+namespace fs = std::filesystem;
+
+constexpr char SampleCacheMagic[8] = {'E', 'E', 'G', 'F', '3', '2', 'C', '\0'};
+constexpr uint32_t SampleCacheVersion = 2;
+constexpr uint64_t SampleCacheAlignment = 16384; // Sections start on page boundaries (16 KB covers macOS and Linux).
+
+// Everything the cached samples depend on. Stored in the sidecar and compared field by field.
+struct SampleCacheKey {
+    uint64_t headerHash;    // FNV-1a of the source's EDF header (signal layout, scaling, start time).
+    uint64_t sourceSize;
+    int64_t sourceMtime;
+    uint64_t selectionHash; // Channel labels and time window.
+    int32_t padding;
+    int32_t format;
+};
+
+struct SampleCacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    SampleCacheKey key;
+    uint64_t metadataOffset;
+    uint64_t metadataBytes;
+    uint64_t samplesOffset;
+    uint64_t samplesCount;
+    uint64_t digitalOffset;
+    uint64_t digitalCount;
+};
+
+// RAII wrapper for the sidecar file descriptor.
+struct CacheFileGuard {
+    int fd;
+
+    explicit CacheFileGuard(const std::string& path) : fd(open(path.c_str(), O_RDONLY)) {}
+
+    ~CacheFileGuard() {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    CacheFileGuard(const CacheFileGuard&) = delete;
+    CacheFileGuard& operator=(const CacheFileGuard&) = delete;
+};
+
+// Helper to hash bytes (FNV-1a, 64-bit), seed allows chaining.
+uint64_t fnv1a(const void* data, const size_t size, uint64_t hash = 1469598103934665603ULL) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+uint64_t align_up(const uint64_t value) {
+    return (value + SampleCacheAlignment - 1) / SampleCacheAlignment * SampleCacheAlignment;
+}
+
+// Helper to read exactly size bytes at offset.
+bool cache_read_at(const int fd, void* dst, size_t size, off_t offset) {
+    uint8_t* out = static_cast<uint8_t*>(dst);
+    while (size > 0) {
+        const ssize_t n = pread(fd, out, size, offset);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+
+        out += n;
+        size -= static_cast<size_t>(n);
+        offset += n;
+    }
+    return true;
+}
+
+SampleCacheKey make_cache_key(const char* filePath, const int padding, const SampleFormat format, const LoadSelection& selection) {
+    SampleCacheKey key = {};
+
+    std::ifstream file(filePath, std::ios::binary);
+    char mainHeader[256];
+    if (!file.read(mainHeader, sizeof(mainHeader))) throw std::runtime_error("Cannot read EDF header");
+    const int signals = std::atoi(std::string(mainHeader + 252, 4).c_str());
+    std::vector<char> signalHeader(static_cast<size_t>(std::max(signals, 0)) * 256);
+    if (!file.read(signalHeader.data(), signalHeader.size())) throw std::runtime_error("Cannot read EDF signal header");
+
+    key.headerHash = fnv1a(signalHeader.data(), signalHeader.size(), fnv1a(mainHeader, sizeof(mainHeader)));
+    key.sourceSize = static_cast<uint64_t>(fs::file_size(filePath));
+    key.sourceMtime = static_cast<int64_t>(fs::last_write_time(filePath).time_since_epoch().count());
+
+    uint64_t selectionHash = fnv1a(&selection.startSec, sizeof(selection.startSec));
+    selectionHash = fnv1a(&selection.durationSec, sizeof(selection.durationSec), selectionHash);
+    for (const auto& label : selection.channels) {
+        selectionHash = fnv1a(label.data(), label.size() + 1, selectionHash);
+    }
+    key.selectionHash = selectionHash;
+    key.padding = padding;
+    key.format = static_cast<int32_t>(format);
+    return key;
+}
+
+std::string cache_path(const char* filePath, const SampleCacheKey& key) {
+    char name[17];
+    snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(fnv1a(&key, sizeof(key))));
+    return std::string(SAMPLE_CACHE_DIR) + "/" + fs::path(filePath).stem().string() + "." + name + ".f32cache";
+}
+
+// Metadata serialization (native byte order, the sidecar is a local cache, not an exchange format).
+struct CacheWriter {
+    std::string bytes;
+
+    template <typename T> void pod(const T& value) { bytes.append(reinterpret_cast<const char*>(&value), sizeof(T)); }
+    void str(const std::string& value) { pod<uint64_t>(value.size()); bytes += value; }
+    template <typename T> void vec(const std::vector<T>& values) {
+        pod<uint64_t>(values.size());
+        bytes.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+    }
+};
+
+struct CacheReader {
+    const char* pos;
+    const char* end;
+
+    void take(void* dst, const size_t size) {
+        if (static_cast<size_t>(end - pos) < size) throw std::runtime_error("Truncated sample cache metadata");
+        std::memcpy(dst, pos, size);
+        pos += size;
+    }
+    template <typename T> T pod() { T value; take(&value, sizeof(T)); return value; }
+    std::string str() {
+        const uint64_t size = pod<uint64_t>();
+        if (static_cast<uint64_t>(end - pos) < size) throw std::runtime_error("Truncated sample cache metadata");
+        std::string value(pos, size);
+        pos += size;
+        return value;
+    }
+    template <typename T> std::vector<T> vec() {
+        const uint64_t size = pod<uint64_t>();
+        if (static_cast<uint64_t>(end - pos) / sizeof(T) < size) throw std::runtime_error("Truncated sample cache metadata");
+        std::vector<T> values(size);
+        take(values.data(), size * sizeof(T));
+        return values;
+    }
+};
+
+std::string serialize_metadata(const EdfData& data) {
+    CacheWriter w;
+    w.str(data.header.patient);
+    w.str(data.header.recording);
+    w.pod(data.header.startdate_day); w.pod(data.header.startdate_month); w.pod(data.header.startdate_year);
+    w.pod(data.header.starttime_hour); w.pod(data.header.starttime_minute); w.pod(data.header.starttime_second);
+    w.pod<int64_t>(data.header.starttime_subsecond);
+    w.pod<int64_t>(data.header.data_record_duration);
+    w.pod(data.header.num_signals);
+
+    w.pod<uint64_t>(data.channels.size());
+    for (const auto& ch : data.channels) {
+        w.str(ch.label); w.str(ch.dimension); w.str(ch.transducer); w.str(ch.prefilter);
+        w.pod(ch.phys_min); w.pod(ch.phys_max); w.pod(ch.dig_min); w.pod(ch.dig_max);
+        w.pod(ch.smp_in_datarecord); w.pod(ch.scale); w.pod(ch.offset);
+    }
+
+    w.str(data.records.filePath);
+    w.pod<uint64_t>(data.records.headerSize);
+    w.pod<uint64_t>(data.records.recordSize);
+    w.pod<uint64_t>(data.records.bytesPerSample);
+    w.pod<int64_t>(data.records.recordCount);
+    w.vec(data.records.channelOffsets);
+
+    w.vec(data.channelStarts);
+    w.vec(data.channelLengths);
+    w.pod<uint64_t>(data.totalSamplesPadded);
+    w.pod(data.padding);
+    return w.bytes;
+}
+
+void deserialize_metadata(const std::vector<char>& bytes, EdfData& data) {
+    CacheReader r{bytes.data(), bytes.data() + bytes.size()};
+    data.header.patient = r.str();
+    data.header.recording = r.str();
+    data.header.startdate_day = r.pod<int>(); data.header.startdate_month = r.pod<int>(); data.header.startdate_year = r.pod<int>();
+    data.header.starttime_hour = r.pod<int>(); data.header.starttime_minute = r.pod<int>(); data.header.starttime_second = r.pod<int>();
+    data.header.starttime_subsecond = r.pod<int64_t>();
+    data.header.data_record_duration = static_cast<long>(r.pod<int64_t>());
+    data.header.num_signals = r.pod<int>();
+
+    data.channels.resize(r.pod<uint64_t>());
+    for (auto& ch : data.channels) {
+        ch.label = r.str(); ch.dimension = r.str(); ch.transducer = r.str(); ch.prefilter = r.str();
+        ch.phys_min = r.pod<double>(); ch.phys_max = r.pod<double>(); ch.dig_min = r.pod<int>(); ch.dig_max = r.pod<int>();
+        ch.smp_in_datarecord = r.pod<int>(); ch.scale = r.pod<double>(); ch.offset = r.pod<double>();
+    }
+
+    data.records.filePath = r.str();
+    data.records.headerSize = r.pod<uint64_t>();
+    data.records.recordSize = r.pod<uint64_t>();
+    data.records.bytesPerSample = r.pod<uint64_t>();
+    data.records.recordCount = r.pod<int64_t>();
+    data.records.channelOffsets = r.vec<size_t>();
+
+    data.channelStarts = r.vec<size_t>();
+    data.channelLengths = r.vec<int>();
+    data.totalSamplesPadded = r.pod<uint64_t>();
+    data.padding = r.pod<int>();
+
+    if (data.channelStarts.size() != data.channels.size() || data.channelLengths.size() != data.channels.size()) {
+        throw std::runtime_error("Inconsistent sample cache metadata");
+    }
+}
+
+/**
+ * Loads the decoded samples from the sidecar cache, if a valid one exists.
+ * The sidecar is keyed by the source's header hash, size, modification time, the padding, the sample format and
+ * the selection, so a changed source (or request) misses the cache and is decoded again.
+ *
+ * @return True if data was filled from the cache.
+ */
+bool load_sample_cache(const char* filePath, const int padding, const SampleFormat format, const LoadSelection& selection, EdfData& data) {
+    try {
+        const SampleCacheKey key = make_cache_key(filePath, padding, format, selection);
+        const std::string path = cache_path(filePath, key);
+
+        CacheFileGuard file(path);
+        if (file.fd < 0) return false;
+
+        SampleCacheHeader header;
+        if (!cache_read_at(file.fd, &header, sizeof(header), 0)) return false;
+        if (std::memcmp(header.magic, SampleCacheMagic, sizeof(SampleCacheMagic)) != 0 || header.version != SampleCacheVersion ||
+            std::memcmp(&header.key, &key, sizeof(key)) != 0) {
+            return false;
+        }
+
+        std::vector<char> metadata(header.metadataBytes);
+        if (!cache_read_at(file.fd, metadata.data(), metadata.size(), static_cast<off_t>(header.metadataOffset))) return false;
+        deserialize_metadata(metadata, data);
+
+        if (header.samplesCount > 0) {
+            // Read into the pooled buffers, so they return to the pool as usual.
+            data.samples.resize(header.samplesCount);
+            if (!cache_read_at(file.fd, data.samples.data(), header.samplesCount * sizeof(float), static_cast<off_t>(header.samplesOffset))) return false;
+        }
+        if (header.digitalCount > 0) {
+            data.digitalSamples.resize(header.digitalCount);
+            if (!cache_read_at(file.fd, data.digitalSamples.data(), header.digitalCount * sizeof(int16_t), static_cast<off_t>(header.digitalOffset))) return false;
+        }
+
+        std::cout << "Loaded from sample cache: " << path << "\n";
+        std::cout << "Signal count: " << data.header.num_signals << "\n";
+        std::cout << "========================================\n";
+        return true;
+    } catch (const std::exception& e) {
+        std::cout << "Sample cache ignored: " << e.what() << std::endl;
+        data = EdfData();
+        return false;
+    }
+}
+
+/**
+ * Writes the decoded samples and metadata to the sidecar cache. The file is written under a temporary
+ * name and renamed, so an interrupted write never leaves a valid-looking sidecar. Failures only print a warning.
+ */
+void save_sample_cache(const char* filePath, const int padding, const SampleFormat format, const LoadSelection& selection, const EdfData& data) {
+    std::string tempPath;
+    try {
+        const SampleCacheKey key = make_cache_key(filePath, padding, format, selection);
+        const std::string path = cache_path(filePath, key);
+        tempPath = path + ".tmp";
+        fs::create_directories(SAMPLE_CACHE_DIR);
+
+        const std::string metadata = serialize_metadata(data);
+
+        SampleCacheHeader header = {};
+        std::memcpy(header.magic, SampleCacheMagic, sizeof(SampleCacheMagic));
+        header.version = SampleCacheVersion;
+        header.key = key;
+        header.metadataOffset = sizeof(SampleCacheHeader);
+        header.metadataBytes = metadata.size();
+        header.samplesOffset = align_up(header.metadataOffset + header.metadataBytes);
+        header.samplesCount = data.samples.size();
+        header.digitalOffset = align_up(header.samplesOffset + header.samplesCount * sizeof(float));
+        header.digitalCount = data.digitalSamples.size();
+
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out) throw std::runtime_error("Cannot create " + tempPath);
+
+        const std::vector<char> zeros(SampleCacheAlignment, 0);
+        auto pad_to = [&](const uint64_t offset) {
+            const uint64_t current = static_cast<uint64_t>(out.tellp());
+            if (offset > current) out.write(zeros.data(), static_cast<std::streamsize>(offset - current));
+        };
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(metadata.data(), static_cast<std::streamsize>(metadata.size()));
+        pad_to(header.samplesOffset);
+        out.write(reinterpret_cast<const char*>(data.samples.data()), static_cast<std::streamsize>(header.samplesCount * sizeof(float)));
+        pad_to(header.digitalOffset);
+        out.write(reinterpret_cast<const char*>(data.digitalSamples.data()), static_cast<std::streamsize>(header.digitalCount * sizeof(int16_t)));
+        out.close();
+        if (!out) throw std::runtime_error("Write failed");
+
+        fs::rename(tempPath, path);
+        std::cout << "Sample cache written: " << path << std::endl;
+    } catch (const std::exception& e) {
+        std::cout << "Sample cache not written: " << e.what() << std::endl;
+        std::error_code ec;
+        if (!tempPath.empty()) fs::remove(tempPath, ec);
+    }
+}
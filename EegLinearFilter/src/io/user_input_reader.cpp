@@ -17,6 +17,8 @@
 #include <cctype>
 #include <iomanip>
 #include <cmath>
+#include <sstream>
+#include <vector>
 #include "../../lib/magic_enum/magic_enum.hpp"
 
 namespace fs = std::filesystem;
@@ -28,8 +30,12 @@ enum class StepResult {
 
 enum class ConfigStep {
     FILE_INPUT,
+    FOLLOW_PREF,
+    CHANNEL_SELECT,
+    TIME_WINDOW,
     MODE_SELECT,
     ITERATIONS,
+    RECORD_OUTPUT,
     SAVE_PREF,
     OUT_DIR,
     FINISHED
@@ -134,14 +140,97 @@ std::optional<std::string> try_parse_filepath(const std::string& input) {
         return std::nullopt;
     }
 
-    if (path.extension() != ".edf") {
-        std::cout << "Error: File must have .edf extension." << std::endl;
+    if (path.extension() != ".edf" && path.extension() != ".bdf") {
+        std::cout << "Error: File must have .edf or .bdf extension." << std::endl;
         return std::nullopt;
     }
     
     return path.string();
 }
 
+// A directory or a .txt list of files starts batch processing.
+bool is_batch_input(const std::string& input) {
+    const fs::path path(trim(input));
+    std::error_code ec;
+    return !path.empty() && (fs::is_directory(path, ec) || path.extension() == ".txt");
+}
+
+std::optional<std::vector<std::string>> try_parse_batch(const std::string& input) {
+    const fs::path path(trim(input));
+    std::vector<std::string> files;
+    std::error_code ec;
+
+    if (fs::is_directory(path, ec)) {
+        for (const auto& entry : fs::recursive_directory_iterator(path, ec)) {
+            const fs::path& file = entry.path();
+            if (entry.is_regular_file(ec) && (file.extension() == ".edf" || file.extension() == ".bdf")) {
+                files.push_back(file.string());
+            }
+        }
+        std::sort(files.begin(), files.end());
+    } else {
+        std::ifstream list(path);
+        if (!list.is_open()) {
+            std::cout << "Error: Cannot open file list: " << path << std::endl;
+            return std::nullopt;
+        }
+        std::string line;
+        while (std::getline(list, line)) {
+            line = trim(line);
+            if (line.empty()) continue;
+            if (!fs::is_regular_file(line, ec)) {
+                std::cout << "Error: File does not exist: " << line << std::endl;
+                return std::nullopt;
+            }
+            files.push_back(line);
+        }
+    }
+
+    if (files.empty()) {
+        std::cout << "Error: No .edf or .bdf files found in " << path << std::endl;
+        return std::nullopt;
+    }
+    return files;
+}
+
+std::optional<std::vector<std::string>> try_parse_channels(const std::string& input, const std::vector<std::string>& available) {
+    std::vector<std::string> channels;
+    std::stringstream stream(input);
+    std::string label;
+
+    while (std::getline(stream, label, ',')) {
+        label = trim(label);
+        if (label.empty()) continue;
+
+        if (std::find(available.begin(), available.end(), label) == available.end()) {
+            std::cout << "Error: Unknown channel: " << label << std::endl;
+            return std::nullopt;
+        }
+        channels.push_back(label);
+    }
+    return channels;
+}
+
+std::optional<std::pair<double, double>> try_parse_time_window(const std::string& input) {
+    std::string clean_input = trim(input);
+    if (clean_input.empty()) return std::make_pair(0.0, 0.0);
+
+    std::istringstream stream(clean_input);
+    double start = 0.0;
+    double duration = 0.0;
+    std::string rest;
+
+    if (!(stream >> start) || start < 0.0) {
+        std::cout << "Invalid input. Enter a non-negative start time in seconds." << std::endl;
+        return std::nullopt;
+    }
+    if (!stream.eof() && (!(stream >> duration) || duration <= 0.0 || (stream >> rest))) {
+        std::cout << "Invalid input. Enter '<start> [duration]' in seconds (positive duration)." << std::endl;
+        return std::nullopt;
+    }
+    return std::make_pair(start, duration);
+}
+
 std::optional<int> try_parse_mode(const std::string& input) {
     std::string clean_input = trim(input);
     if (clean_input.empty()) return DEFAULT_MODE_INDEX;
@@ -179,9 +268,9 @@ std::optional<int> try_parse_iterations(const std::string& input) {
     return std::nullopt;
 }
 
-std::optional<bool> try_parse_save_pref(const std::string& input) {
+std::optional<bool> try_parse_yes_no(const std::string& input, const bool defaultValue) {
     std::string clean_input = trim(input);
-    if (clean_input.empty()) return DEFAULT_SAVE;
+    if (clean_input.empty()) return defaultValue;
 
     if (clean_input.length() == 1) {
         char response = std::tolower(clean_input[0]);
@@ -193,6 +282,18 @@ std::optional<bool> try_parse_save_pref(const std::string& input) {
     return std::nullopt;
 }
 
+std::optional<bool> try_parse_follow(const std::string& input) {
+    return try_parse_yes_no(input, DEFAULT_FOLLOW);
+}
+
+std::optional<bool> try_parse_record_output(const std::string& input) {
+    return try_parse_yes_no(input, DEFAULT_RECORD_OUTPUT);
+}
+
+std::optional<bool> try_parse_save_pref(const std::string& input) {
+    return try_parse_yes_no(input, DEFAULT_SAVE);
+}
+
 std::optional<std::string> try_parse_output_dir(const std::string& input) {
     std::string clean_input = trim(input);
     std::string path_str = clean_input.empty() ? DEFAULT_OUT_DIR : clean_input;
@@ -245,11 +346,76 @@ StepResult get_input_file_path(AppConfig& config) {
     std::string input_buffer;
     while (true) {
         std::cout << "Enter path to the input EDF file:\n";
-        std::cout << "(Default: " << DEFAULT_FILE_DATASET_NAME << ")\n";
+        std::cout << "(Default: " << DEFAULT_FILE_DATASET_NAME << ", a directory or a .txt list of files runs a batch)\n";
         if (!read_input(input_buffer)) return StepResult::BACK;
 
-        if (auto result = try_parse_filepath(input_buffer)) {
+        if (is_batch_input(input_buffer)) {
+            if (auto result = try_parse_batch(input_buffer)) {
+                std::cout << "Batch of " << result->size() << " file(s)." << std::endl;
+                config.filePath = "";
+                config.batchFiles = *result;
+                return StepResult::NEXT;
+            }
+        } else if (auto result = try_parse_filepath(input_buffer)) {
             config.filePath = *result;
+            config.batchFiles.clear();
+            return StepResult::NEXT;
+        }
+    }
+}
+
+StepResult get_follow_preference(AppConfig& config) {
+    std::string input_buffer;
+    while (true) {
+        std::cout << "Follow the file as it grows (live recording)? (y/n):\n";
+        std::cout << "(Default " << (DEFAULT_FOLLOW ? "y" : "n") << ")\n";
+        if (!read_input(input_buffer)) return StepResult::BACK;
+
+        if (auto result = try_parse_follow(input_buffer)) {
+            config.followFile = *result;
+            return StepResult::NEXT;
+        }
+    }
+}
+
+StepResult get_channel_selection(AppConfig& config) {
+    std::vector<std::string> labels;
+    try {
+        labels = read_channel_labels(config.filePath.c_str());
+    } catch (const std::exception& e) {
+        std::cout << "Error: " << e.what() << std::endl;
+        return StepResult::BACK;
+    }
+
+    std::cout << "Available channels:\n";
+    for (size_t i = 0; i < labels.size(); ++i) {
+        std::cout << (i > 0 ? ", " : " ") << labels[i];
+    }
+    std::cout << "\n";
+
+    std::string input_buffer;
+    while (true) {
+        std::cout << "Enter comma-separated channel labels to load:\n";
+        std::cout << "(Default: all channels)\n";
+        if (!read_input(input_buffer)) return StepResult::BACK;
+
+        if (auto result = try_parse_channels(input_buffer, labels)) {
+            config.selection.channels = *result;
+            return StepResult::NEXT;
+        }
+    }
+}
+
+StepResult get_time_window(AppConfig& config) {
+    std::string input_buffer;
+    while (true) {
+        std::cout << "Enter time window to load as '<start> [duration]' in seconds:\n";
+        std::cout << "(Default: whole recording)\n";
+        if (!read_input(input_buffer)) return StepResult::BACK;
+
+        if (auto result = try_parse_time_window(input_buffer)) {
+            config.selection.startSec = result->first;
+            config.selection.durationSec = result->second;
             return StepResult::NEXT;
         }
     }
@@ -271,6 +437,10 @@ StepResult set_processing_mode(AppConfig& config) {
 
         if (auto result = try_parse_mode(input_buffer)) {
             int mode_index = *result;
+            if (mode_index == -1 && config.followFile) {
+                std::cout << "Follow mode runs a single mode, select one between 0 and " << max_val << "." << std::endl;
+                continue;
+            }
             if (mode_index == -1) {
                 config.runAllVariants = true;
                 config.mode = std::nullopt;
@@ -297,6 +467,20 @@ StepResult get_iteration_count(AppConfig& config) {
     }
 }
 
+StepResult get_record_output(AppConfig& config) {
+    std::string input_buffer;
+    while (true) {
+        std::cout << "Quantize the output directly into EDF records (int16)? (y/n):\n";
+        std::cout << "(Default " << (DEFAULT_RECORD_OUTPUT ? "y" : "n") << ")\n";
+        if (!read_input(input_buffer)) return StepResult::BACK;
+
+        if (auto result = try_parse_record_output(input_buffer)) {
+            config.recordOutput = *result;
+            return StepResult::NEXT;
+        }
+    }
+}
+
 StepResult get_save_preference(AppConfig& config) {
     std::string input_buffer;
     while (true) {
@@ -342,20 +526,62 @@ AppConfig read_user_input() {
             case ConfigStep::FILE_INPUT:
                 result = get_input_file_path(config);
                 if (result == StepResult::NEXT) {
-                    currentStep = ConfigStep::MODE_SELECT;
+                    // A batch processes whole files and cannot follow them.
+                    currentStep = config.batchFiles.empty() ? ConfigStep::FOLLOW_PREF : ConfigStep::MODE_SELECT;
+                    if (!config.batchFiles.empty()) {
+                        config.followFile = false;
+                        config.selection = {};
+                    }
                 } else {
                     std::cout << "Already at the beginning.\n";
                 }
                 break;
 
+            case ConfigStep::FOLLOW_PREF:
+                result = get_follow_preference(config);
+                if (result == StepResult::NEXT) {
+                    // A growing recording is filtered whole, once, and always saved.
+                    currentStep = config.followFile ? ConfigStep::MODE_SELECT : ConfigStep::CHANNEL_SELECT;
+                    if (config.followFile) {
+                        config.selection = {};
+                        config.iterationCount = 1;
+                        config.recordOutput = true;
+                        config.saveResults = true;
+                    }
+                } else {
+                    currentStep = ConfigStep::FILE_INPUT;
+                }
+                break;
+
+            case ConfigStep::CHANNEL_SELECT:
+                result = get_channel_selection(config);
+                currentStep = (result == StepResult::NEXT) ? ConfigStep::TIME_WINDOW : ConfigStep::FOLLOW_PREF;
+                break;
+
+            case ConfigStep::TIME_WINDOW:
+                result = get_time_window(config);
+                currentStep = (result == StepResult::NEXT) ? ConfigStep::MODE_SELECT : ConfigStep::CHANNEL_SELECT;
+                break;
+
             case ConfigStep::MODE_SELECT:
                 result = set_processing_mode(config);
-                currentStep = (result == StepResult::NEXT) ? ConfigStep::ITERATIONS : ConfigStep::FILE_INPUT;
+                if (config.followFile) {
+                    currentStep = (result == StepResult::NEXT) ? ConfigStep::OUT_DIR : ConfigStep::FOLLOW_PREF;
+                } else if (!config.batchFiles.empty()) {
+                    currentStep = (result == StepResult::NEXT) ? ConfigStep::ITERATIONS : ConfigStep::FILE_INPUT;
+                } else {
+                    currentStep = (result == StepResult::NEXT) ? ConfigStep::ITERATIONS : ConfigStep::TIME_WINDOW;
+                }
                 break;
 
             case ConfigStep::ITERATIONS:
                 result = get_iteration_count(config);
-                currentStep = (result == StepResult::NEXT) ? ConfigStep::SAVE_PREF : ConfigStep::MODE_SELECT;
+                currentStep = (result == StepResult::NEXT) ? ConfigStep::RECORD_OUTPUT : ConfigStep::MODE_SELECT;
+                break;
+
+            case ConfigStep::RECORD_OUTPUT:
+                result = get_record_output(config);
+                currentStep = (result == StepResult::NEXT) ? ConfigStep::SAVE_PREF : ConfigStep::ITERATIONS;
                 break;
 
             case ConfigStep::SAVE_PREF:
@@ -366,13 +592,17 @@ AppConfig read_user_input() {
                         config.outputFolderPath = "";
                     }
                 } else {
-                    currentStep = ConfigStep::ITERATIONS;
+                    currentStep = ConfigStep::RECORD_OUTPUT;
                 }
                 break;
 
             case ConfigStep::OUT_DIR:
                 result = get_output_folder(config);
-                currentStep = (result == StepResult::NEXT) ? ConfigStep::FINISHED : ConfigStep::SAVE_PREF;
+                if (result == StepResult::NEXT) {
+                    currentStep = ConfigStep::FINISHED;
+                } else {
+                    currentStep = config.followFile ? ConfigStep::MODE_SELECT : ConfigStep::SAVE_PREF;
+                }
                 break;
                 
             case ConfigStep::FINISHED: break;
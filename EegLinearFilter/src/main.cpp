@@ -9,12 +9,40 @@
 #include <IOKit/pwr_mgt/IOPMLib.h>
 #include <iostream>
 #include <vector>
+#include <chrono>
 
 #include "io/io.hpp"
 #include "benchmarks.hpp"
+#include "follow.hpp"
+#include "batch.hpp"
 #include "convolution_kernels.hpp"
 #include "config.h"
 
+/**
+ * Prints how large buffers are faulted in.
+ */
+void print_memory_info() {
+    std::cout << "Prefault: " << (PREFAULT_BUFFERS ? "parallel" : "off") << " (buffers of at least "
+              << (PREFAULT_MIN_BYTES / 1024 / 1024) << " MB)" << std::endl;
+    std::cout << "========================================\n";
+}
+
+/**
+ * Prints how much memory the buffer pool took from the OS and how much it handed out again.
+ * Every reused byte was already faulted in, so reused bytes / page size is an upper estimate of the page faults
+ * avoided (not measured, pre-faulting makes the real number smaller).
+ */
+void print_buffer_pool_stats() {
+    const BufferPoolStats stats = BufferPool::get().snapshot();
+    const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+
+    std::cout << "Buffer pool: " << stats.reuses << "/" << stats.requests << " buffers reused | "
+              << (stats.bytesAllocated / 1024 / 1024) << " MB allocated | "
+              << (stats.bytesReused / 1024 / 1024) << " MB reused | "
+              << (stats.bytesCached / 1024 / 1024) << " MB cached" << std::endl;
+    std::cout << "Page faults avoided (estimate, reused bytes / page size): ~" << (stats.bytesReused / pageSize) << std::endl;
+}
+
 void print_welcome_banner() {
     std::cout << "========================================" << std::endl;
     std::cout << "                                        " << std::endl;
@@ -43,21 +71,70 @@ int main(int argc, const char * argv[]) {
         
         try {
             const std::vector<float> convolutionKernel = create_gaussian_kernel<KERNEL_RADIUS>(KERNEL_SIGMA);
-            const EdfData loadedData = load_edf_data(config.filePath.c_str(), KERNEL_RADIUS);
-            NeonVector outputBuffer(loadedData.samples.size(), 0.0f);
+            if (config.followFile) {
+                run_follow(config.mode.value(), config.filePath, convolutionKernel, config.outputFolderPath);
+                BufferPool::get().trim();
+                std::cout << "========================================\n";
+                keepRunning = ask_to_continue();
+                continue;
+            }
+            if (!config.batchFiles.empty()) {
+                run_batch(config, convolutionKernel);
+                print_buffer_pool_stats();
+                BufferPool::get().trim();
+                std::cout << "========================================\n";
+                keepRunning = ask_to_continue();
+                continue;
+            }
+
+            // A single fixed-point, FP16 or fused mode keeps only what it needs (int16 / FP16 samples / nothing).
+            const SampleFormat sampleFormat = config.runAllVariants ? SampleFormat::ALL : required_sample_format(config.mode.value());
+            
+            const auto load_start = std::chrono::high_resolution_clock::now();
+            EdfData loadedData = load_edf_data(config.filePath.c_str(), KERNEL_RADIUS, sampleFormat, config.selection);
+            std::cout << "Load time: " << std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - load_start).count() << "s" << std::endl;
+            const bool is24Bit = loadedData.records.bytesPerSample == 3;
+            if (is24Bit && config.recordOutput) {
+                std::cout << "Record output supports 16-bit EDF only, exporting physical samples instead." << std::endl;
+                config.recordOutput = false;
+            }
+            // A single mode with a fused record output stage never touches the float output buffer.
+            const bool floatOutputNeeded = config.runAllVariants || !config.recordOutput || !supports_fused_record_output(config.mode.value());
+            NeonVector outputBuffer;
+            if (!config.runAllVariants && filters_in_place(config.mode.value())) {
+                // A single in-place mode takes over the samples, so the run needs one dataset-sized buffer.
+                outputBuffer = std::move(loadedData.samples);
+                if (config.iterationCount > 1) {
+                    std::cout << "In-place mode consumes its input, running a single iteration." << std::endl;
+                    config.iterationCount = 1;
+                }
+            } else {
+                outputBuffer.assign(floatOutputNeeded ? loadedData.totalSamplesPadded : 0, 0.0f);
+            }
+            print_memory_info();
             
             if (config.runAllVariants) {
                 std::cout << "Starting benchmark suite" << std::endl;
                 std::cout << "========================================\n";
                 
                 for (int i = 0; i < (int)ProcessingMode::COUNT; ++i) {
-                    run_benchmark(static_cast<ProcessingMode>(i), fs::path(config.filePath).filename().string(), loadedData, outputBuffer, convolutionKernel, config.iterationCount, config.saveResults, config.outputFolderPath);
+                    if (is24Bit && requires_16bit_samples(static_cast<ProcessingMode>(i))) {
+                        std::cout << "Mode: " << magic_enum::enum_name(static_cast<ProcessingMode>(i)) << " skipped (requires 16-bit EDF samples)" << std::endl;
+                        std::cout << "========================================\n";
+                        continue;
+                    }
+                    run_benchmark(static_cast<ProcessingMode>(i), fs::path(config.filePath).filename().string(), loadedData, outputBuffer, convolutionKernel, config.iterationCount, config.saveResults, config.outputFolderPath, config.recordOutput);
                 }
             } else {
-                run_benchmark(config.mode.value(), fs::path(config.filePath).filename().string(), loadedData, outputBuffer, convolutionKernel, config.iterationCount, config.saveResults, config.outputFolderPath);
+                run_benchmark(config.mode.value(), fs::path(config.filePath).filename().string(), loadedData, outputBuffer, convolutionKernel, config.iterationCount, config.saveResults, config.outputFolderPath, config.recordOutput);
             }
             
             std::cout << "Done!" << std::endl;
+            print_buffer_pool_stats();
+            // Give the file's buffers back to the OS before waiting for the next input.
+            loadedData = EdfData();
+            outputBuffer = NeonVector();
+            BufferPool::get().trim();
             std::cout << "========================================\n";
             keepRunning = ask_to_continue();
             
@@ -0,0 +1,47 @@
+//
+//  page_faults.hpp
+//  EegLinearFilter
+//
+//  Parallel pre-faulting of large buffers and page-fault counters.
+//
+
+#ifndef PAGE_FAULTS_HPP
+#define PAGE_FAULTS_HPP
+
+#include "config.h"
+#include <dispatch/dispatch.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstddef>
+
+// Bytes touched by one GCD task while pre-faulting.
+constexpr size_t PrefaultBlockBytes = 2 * 1024 * 1024;
+
+/**
+ * Touches every page of the buffer, one GCD task per PrefaultBlockBytes block, so the page faults are
+ * served by all cores instead of the first (serial) write of the owning std::vector.
+ */
+inline void prefault_pages(void* buffer, const size_t bytes) {
+    const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t blocks = (bytes + PrefaultBlockBytes - 1) / PrefaultBlockBytes;
+    volatile char* base = static_cast<volatile char*>(buffer);
+
+    dispatch_apply(blocks, dispatch_get_global_queue(QOS_CLASS_USER_INTERACTIVE, 0), ^(size_t block) {
+        const size_t end = std::min(bytes, (block + 1) * PrefaultBlockBytes);
+        for (size_t offset = block * PrefaultBlockBytes; offset < end; offset += pageSize) {
+            base[offset] = 0;
+        }
+    });
+}
+
+/**
+ * Number of page faults served so far by the process (all threads).
+ */
+inline long long process_page_faults() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<long long>(usage.ru_minflt) + usage.ru_majflt;
+}
+
+#endif // PAGE_FAULTS_HPP
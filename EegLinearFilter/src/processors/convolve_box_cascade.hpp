@@ -0,0 +1,120 @@
+//
+//  convolve_box_cascade.hpp
+//  EegLinearFilter
+//
+//  Gaussian approximation by a cascade of moving averages computed with running (prefix) sums.
+//
+
+#ifndef CONVOLVE_BOX_CASCADE
+#define CONVOLVE_BOX_CASCADE
+
+#include "../data_types.hpp"
+#include "../convolution_kernels.hpp"
+#include <dispatch/dispatch.h>
+#include <arm_neon.h>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * Computes odd box widths whose cascade has (approximately) the variance of the given Gaussian.
+ * The first boxes use the lower width, the rest the next odd width, so the total variance
+ * matches 12 * sigma^2 as closely as possible.
+ *
+ * @param sigma Standard deviation of the target Gaussian (in samples).
+ * @param passes Number of cascaded boxes.
+ * @return Vector of odd box widths.
+ */
+inline std::vector<int> box_cascade_widths(const double sigma, const int passes) {
+    const double ideal = std::sqrt(12.0 * sigma * sigma / passes + 1.0);
+    int lower = static_cast<int>(std::floor(ideal));
+    if (lower % 2 == 0) --lower;
+    lower = std::max(lower, 1);
+    const int upper = lower + 2;
+
+    const double lowerCountIdeal = (12.0 * sigma * sigma - passes * lower * lower - 4.0 * passes * lower - 3.0 * passes) / (-4.0 * lower - 4.0);
+    const int lowerCount = std::clamp(static_cast<int>(std::round(lowerCountIdeal)), 0, passes);
+
+    std::vector<int> widths(passes, upper);
+    std::fill_n(widths.begin(), lowerCount, lower);
+    return widths;
+}
+
+/**
+ * Parallel box-filter cascade.
+ *
+ * Every pass is a moving average evaluated as a difference of two prefix sums, so the cost per
+ * sample does not depend on the kernel size. Chunks are independent: each one seeds its prefix sums
+ * at its own left edge (with a halo of the cascade's support), which keeps the double accumulators small
+ * and prevents drift over multi-hour recordings. The differences are vectorized with Neon (float64x2).
+ *
+ * @tparam Radius Kernel radius (the cascade's support must fit into it).
+ * @tparam ChunkSize Elements per GCD task.
+ * @param passes Number of cascaded boxes.
+ * @throws std::runtime_error if the cascade's support exceeds the kernel radius.
+ */
+template <int Radius, int ChunkSize>
+void convolve_par_box_cascade(const NeonVector& data, NeonVector& outputBuffer, const std::vector<float>& convolutionKernel, const int passes) {
+    constexpr size_t KernelSize = 2 * Radius + 1;
+    const size_t outSize = data.size() - KernelSize + 1;
+
+    const std::vector<int> widths = box_cascade_widths(estimate_gaussian_sigma(convolutionKernel), passes);
+
+    size_t halo = 0;
+    for (int w : widths) halo += (w - 1) / 2;
+    if (halo > static_cast<size_t>(Radius)) {
+        throw std::runtime_error("Box cascade support exceeds the kernel radius");
+    }
+
+    const float* __restrict dataPtr = data.data();
+    float* __restrict outputPtr = outputBuffer.data();
+    const int* widthsPtr = widths.data();
+    const size_t numChunks = (outSize + ChunkSize - 1) / ChunkSize;
+
+    dispatch_apply(numChunks, dispatch_get_global_queue(QOS_CLASS_USER_INTERACTIVE, 0), ^(size_t chunkIndex) {
+        const size_t start = chunkIndex * ChunkSize;
+        const size_t actualChunkSize = std::min(static_cast<size_t>(ChunkSize), outSize - start);
+
+        // Output i is centered at input i + Radius, the cascade needs `halo` samples on each side.
+        const float* d_chunk = dataPtr + start + Radius - halo;
+        float* o_chunk = outputPtr + start;
+        size_t length = actualChunkSize + 2 * halo;
+
+        std::vector<double> prefix(length + 1);
+        std::vector<double> stage(length);
+
+        for (int p = 0; p < passes; ++p) {
+            const size_t w = static_cast<size_t>(widthsPtr[p]);
+            const float64x2_t invW = vdupq_n_f64(1.0 / w);
+
+            prefix[0] = 0.0;
+            if (p == 0) {
+                for (size_t j = 0; j < length; ++j) prefix[j + 1] = prefix[j] + d_chunk[j];
+            } else {
+                for (size_t j = 0; j < length; ++j) prefix[j + 1] = prefix[j] + stage[j];
+            }
+
+            length -= w - 1;
+            const double* lo = prefix.data();
+            const double* hi = prefix.data() + w;
+            size_t j = 0;
+
+            if (p + 1 < passes) {
+                for (; j + 2 <= length; j += 2) {
+                    vst1q_f64(stage.data() + j, vmulq_f64(vsubq_f64(vld1q_f64(hi + j), vld1q_f64(lo + j)), invW));
+                }
+                for (; j < length; ++j) stage[j] = (hi[j] - lo[j]) / w;
+            } else {
+                for (; j + 4 <= length; j += 4) {
+                    float64x2_t a = vmulq_f64(vsubq_f64(vld1q_f64(hi + j), vld1q_f64(lo + j)), invW);
+                    float64x2_t b = vmulq_f64(vsubq_f64(vld1q_f64(hi + j + 2), vld1q_f64(lo + j + 2)), invW);
+                    vst1q_f32(o_chunk + j, vcvt_high_f32_f64(vcvt_f32_f64(a), b));
+                }
+                for (; j < length; ++j) o_chunk[j] = static_cast<float>((hi[j] - lo[j]) / w);
+            }
+        }
+    });
+}
+
+#endif // CONVOLVE_BOX_CASCADE
@@ -0,0 +1,217 @@
+//
+//  convolve_compensated.hpp
+//  EegLinearFilter
+//
+//  Manually vectorized convolution with compensated (Neumaier) or FP64 accumulation.
+//
+
+#ifndef CONVOLVE_COMPENSATED
+#define CONVOLVE_COMPENSATED
+
+#include "../data_types.hpp"
+#include <dispatch/dispatch.h>
+#include <arm_neon.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// The compensation terms are algebraically zero, so fast-math reassociation or contraction would
+// fold them away. The arithmetic is written with vector operators (the intrinsics are defined in a
+// header compiled with the global flags) inside regions where both are disabled.
+
+/**
+ * Adds value to sum and collects the rounding error in comp (Neumaier's variant of Kahan summation,
+ * correct also when the added value is larger than the running sum).
+ */
+inline void neumaier_add(float32x4_t& sum, float32x4_t& comp, const float32x4_t value) {
+#pragma clang fp reassociate(off) contract(off)
+    const float32x4_t t = sum + value;
+    const uint32x4_t sumLarger = vcageq_f32(sum, value);
+    const float32x4_t big = vbslq_f32(sumLarger, sum, value);
+    const float32x4_t small = vbslq_f32(sumLarger, value, sum);
+    comp = comp + ((big - t) + small);
+    sum = t;
+}
+
+/**
+ * Adds the product d * w as an exact pair (rounded product + its error recovered by FMA),
+ * so the products do not lose precision before the compensated summation.
+ */
+inline void neumaier_add_product(float32x4_t& sum, float32x4_t& comp, const float32x4_t d, const float32x4_t w) {
+#pragma clang fp reassociate(off) contract(off)
+    const float32x4_t p = d * w;
+    const float32x4_t productError = vfmaq_f32(-p, d, w);
+    neumaier_add(sum, comp, p);
+    comp = comp + productError;
+}
+
+/**
+ * Convolves one chunk with compensated FP32 accumulation. The sum over the whole kernel is kept
+ * in registers (16 outputs, sum and compensation per lane), the compensation is added once at the end.
+ * The error is independent of the kernel length up to a term of the order of the squared unit roundoff.
+ */
+inline void neumaier_chunk(const float* __restrict d_chunk, float* __restrict o_chunk, const size_t actualChunkSize, const float* __restrict kernelPtr, const size_t kernelSize) {
+#pragma clang fp reassociate(off) contract(off)
+    size_t out = 0;
+
+    for (; out + 16 <= actualChunkSize; out += 16) {
+        float32x4_t sum0 = vdupq_n_f32(0.0f); float32x4_t comp0 = vdupq_n_f32(0.0f);
+        float32x4_t sum1 = vdupq_n_f32(0.0f); float32x4_t comp1 = vdupq_n_f32(0.0f);
+        float32x4_t sum2 = vdupq_n_f32(0.0f); float32x4_t comp2 = vdupq_n_f32(0.0f);
+        float32x4_t sum3 = vdupq_n_f32(0.0f); float32x4_t comp3 = vdupq_n_f32(0.0f);
+
+        const float* current_d = d_chunk + out;
+
+        for (size_t k = 0; k < kernelSize; ++k) {
+            const float32x4_t w = vdupq_n_f32(kernelPtr[k]);
+            neumaier_add_product(sum0, comp0, vld1q_f32(current_d + k + 0), w);
+            neumaier_add_product(sum1, comp1, vld1q_f32(current_d + k + 4), w);
+            neumaier_add_product(sum2, comp2, vld1q_f32(current_d + k + 8), w);
+            neumaier_add_product(sum3, comp3, vld1q_f32(current_d + k + 12), w);
+        }
+
+        vst1q_f32(o_chunk + out + 0, sum0 + comp0);
+        vst1q_f32(o_chunk + out + 4, sum1 + comp1);
+        vst1q_f32(o_chunk + out + 8, sum2 + comp2);
+        vst1q_f32(o_chunk + out + 12, sum3 + comp3);
+    }
+
+    for (; out < actualChunkSize; ++out) {
+        float sum = 0.0f;
+        float comp = 0.0f;
+        for (size_t k = 0; k < kernelSize; ++k) {
+            const float p = d_chunk[out + k] * kernelPtr[k];
+            const float productError = std::fma(d_chunk[out + k], kernelPtr[k], -p);
+            const float t = sum + p;
+            comp += (std::abs(sum) >= std::abs(p)) ? (sum - t) + p : (p - t) + sum;
+            comp += productError;
+            sum = t;
+        }
+        o_chunk[out] = sum + comp;
+    }
+}
+
+/**
+ * Convolves one chunk with FP64 accumulation. Samples are widened to double in registers
+ * (two lanes per vector, so 16 outputs need 8 accumulators), the result is rounded to float once.
+ */
+inline void fp64_acc_chunk(const float* __restrict d_chunk, float* __restrict o_chunk, const size_t actualChunkSize, const double* __restrict kernelPtr, const size_t kernelSize) {
+    size_t out = 0;
+
+    for (; out + 16 <= actualChunkSize; out += 16) {
+        float64x2_t acc0 = vdupq_n_f64(0.0); float64x2_t acc1 = vdupq_n_f64(0.0);
+        float64x2_t acc2 = vdupq_n_f64(0.0); float64x2_t acc3 = vdupq_n_f64(0.0);
+        float64x2_t acc4 = vdupq_n_f64(0.0); float64x2_t acc5 = vdupq_n_f64(0.0);
+        float64x2_t acc6 = vdupq_n_f64(0.0); float64x2_t acc7 = vdupq_n_f64(0.0);
+
+        const float* current_d = d_chunk + out;
+
+        for (size_t k = 0; k < kernelSize; ++k) {
+            const float64x2_t w = vdupq_n_f64(kernelPtr[k]);
+            const float32x4_t v0 = vld1q_f32(current_d + k + 0);
+            const float32x4_t v1 = vld1q_f32(current_d + k + 4);
+            const float32x4_t v2 = vld1q_f32(current_d + k + 8);
+            const float32x4_t v3 = vld1q_f32(current_d + k + 12);
+
+            acc0 = vfmaq_f64(acc0, vcvt_f64_f32(vget_low_f32(v0)), w); acc1 = vfmaq_f64(acc1, vcvt_high_f64_f32(v0), w);
+            acc2 = vfmaq_f64(acc2, vcvt_f64_f32(vget_low_f32(v1)), w); acc3 = vfmaq_f64(acc3, vcvt_high_f64_f32(v1), w);
+            acc4 = vfmaq_f64(acc4, vcvt_f64_f32(vget_low_f32(v2)), w); acc5 = vfmaq_f64(acc5, vcvt_high_f64_f32(v2), w);
+            acc6 = vfmaq_f64(acc6, vcvt_f64_f32(vget_low_f32(v3)), w); acc7 = vfmaq_f64(acc7, vcvt_high_f64_f32(v3), w);
+        }
+
+        vst1q_f32(o_chunk + out + 0, vcvt_high_f32_f64(vcvt_f32_f64(acc0), acc1));
+        vst1q_f32(o_chunk + out + 4, vcvt_high_f32_f64(vcvt_f32_f64(acc2), acc3));
+        vst1q_f32(o_chunk + out + 8, vcvt_high_f32_f64(vcvt_f32_f64(acc4), acc5));
+        vst1q_f32(o_chunk + out + 12, vcvt_high_f32_f64(vcvt_f32_f64(acc6), acc7));
+    }
+
+    for (; out < actualChunkSize; ++out) {
+        double sum = 0.0;
+        for (size_t k = 0; k < kernelSize; ++k) sum += static_cast<double>(d_chunk[out + k]) * kernelPtr[k];
+        o_chunk[out] = static_cast<float>(sum);
+    }
+}
+
+/**
+ * Sequential implementation with compensated (Neumaier) FP32 accumulation.
+ *
+ * @tparam Radius Kernel radius.
+ * @tparam ChunkSize Elements per block.
+ */
+template <int Radius, int ChunkSize>
+void convolve_seq_neumaier(const NeonVector& data, NeonVector& outputBuffer, const std::vector<float>& convolutionKernel) {
+    constexpr size_t KernelSize = 2 * Radius + 1;
+    const size_t outSize = data.size() - KernelSize + 1;
+
+    for (size_t start = 0; start < outSize; start += ChunkSize) {
+        const size_t actualChunkSize = std::min(static_cast<size_t>(ChunkSize), outSize - start);
+        neumaier_chunk(data.data() + start, outputBuffer.data() + start, actualChunkSize, convolutionKernel.data(), KernelSize);
+    }
+}
+
+/**
+ * Parallel implementation with compensated (Neumaier) FP32 accumulation.
+ *
+ * @tparam Radius Kernel radius.
+ * @tparam ChunkSize Elements per GCD task.
+ */
+template <int Radius, int ChunkSize>
+void convolve_par_neumaier(const NeonVector& data, NeonVector& outputBuffer, const std::vector<float>& convolutionKernel) {
+    constexpr size_t KernelSize = 2 * Radius + 1;
+    const size_t outSize = data.size() - KernelSize + 1;
+    const size_t numChunks = (outSize + ChunkSize - 1) / ChunkSize;
+
+    const float* __restrict dataPtr = data.data();
+    float* __restrict outputPtr = outputBuffer.data();
+    const float* __restrict kernelPtr = convolutionKernel.data();
+
+    dispatch_apply(numChunks, dispatch_get_global_queue(QOS_CLASS_USER_INTERACTIVE, 0), ^(size_t chunkIndex) {
+        const size_t start = chunkIndex * ChunkSize;
+        const size_t actualChunkSize = std::min(static_cast<size_t>(ChunkSize), outSize - start);
+        neumaier_chunk(dataPtr + start, outputPtr + start, actualChunkSize, kernelPtr, KernelSize);
+    });
+}
+
+/**
+ * Sequential implementation with FP64 accumulation.
+ *
+ * @tparam Radius Kernel radius.
+ * @tparam ChunkSize Elements per block.
+ */
+template <int Radius, int ChunkSize>
+void convolve_seq_fp64_acc(const NeonVector& data, NeonVector& outputBuffer, const std::vector<float>& convolutionKernel) {
+    constexpr size_t KernelSize = 2 * Radius + 1;
+    const size_t outSize = data.size() - KernelSize + 1;
+    const std::vector<double> kernel(convolutionKernel.begin(), convolutionKernel.end());
+
+    for (size_t start = 0; start < outSize; start += ChunkSize) {
+        const size_t actualChunkSize = std::min(static_cast<size_t>(ChunkSize), outSize - start);
+        fp64_acc_chunk(data.data() + start, outputBuffer.data() + start, actualChunkSize, kernel.data(), KernelSize);
+    }
+}
+
+/**
+ * Parallel implementation with FP64 accumulation.
+ *
+ * @tparam Radius Kernel radius.
+ * @tparam ChunkSize Elements per GCD task.
+ */
+template <int Radius, int ChunkSize>
+void convolve_par_fp64_acc(const NeonVector& data, NeonVector& outputBuffer, const std::vector<float>& convolutionKernel) {
+    constexpr size_t KernelSize = 2 * Radius + 1;
+    const size_t outSize = data.size() - KernelSize + 1;
+    const size_t numChunks = (outSize + ChunkSize - 1) / ChunkSize;
+    const std::vector<double> kernel(convolutionKernel.begin(), convolutionKernel.end());
+
+    const float* __restrict dataPtr = data.data();
+    float* __restrict outputPtr = outputBuffer.data();
+    const double* __restrict kernelPtr = kernel.data();
+
+    dispatch_apply(numChunks, dispatch_get_global_queue(QOS_CLASS_USER_INTERACTIVE, 0), ^(size_t chunkIndex) {
+        const size_t start = chunkIndex * ChunkSize;
+        const size_t actualChunkSize = std::min(static_cast<size_t>(ChunkSize), outSize - start);
+        fp64_acc_chunk(dataPtr + start, outputPtr + start, actualChunkSize, kernelPtr, KernelSize);
+    });
+}
+
+#endif // CONVOLVE_COMPENSATED
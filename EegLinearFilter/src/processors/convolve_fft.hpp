@@ -0,0 +1,325 @@
+//
+//  convolve_fft.hpp
+//  EegLinearFilter
+//
+//  Channel-batched overlap-save FFT convolution sharing one kernel spectrum across all channels.
+//
+
+#ifndef CONVOLVE_FFT
+#define CONVOLVE_FFT
+
+#include "../data_types.hpp"
+#include <dispatch/dispatch.h>
+#include <arm_neon.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Precomputed tables of the batched FFT and the kernel spectrum.
+ */
+struct FftPlan {
+    size_t size;                        // FFT length N (power of two).
+    std::vector<float> twiddleRe;       // e^(-2 pi i j / N), j < N / 2.
+    std::vector<float> twiddleIm;
+    std::vector<uint32_t> bitReverse;   // Input permutation of the iterative radix-2 FFT.
+    std::vector<float> kernelRe;        // Spectrum of the reversed, zero-padded kernel, scaled by 1 / N.
+    std::vector<float> kernelIm;
+};
+
+/**
+ * Builds the FFT tables and the kernel spectrum (once per run, evaluated in double).
+ * The 1 / N normalization of the inverse transform is folded into the spectrum.
+ *
+ * @param convolutionKernel The filter kernel.
+ * @param fftSize FFT length (power of two, larger than the kernel).
+ * @return FftPlan used by all channels and blocks.
+ */
+inline FftPlan create_fft_plan(const std::vector<float>& convolutionKernel, const size_t fftSize) {
+    FftPlan plan { fftSize, std::vector<float>(fftSize / 2), std::vector<float>(fftSize / 2), std::vector<uint32_t>(fftSize),
+                   std::vector<float>(fftSize), std::vector<float>(fftSize) };
+
+    std::vector<double> cosTable(fftSize);
+    std::vector<double> sinTable(fftSize);
+    for (size_t j = 0; j < fftSize; ++j) {
+        const double angle = 2.0 * M_PI * static_cast<double>(j) / static_cast<double>(fftSize);
+        cosTable[j] = std::cos(angle);
+        sinTable[j] = -std::sin(angle);
+    }
+
+    for (size_t j = 0; j < fftSize / 2; ++j) {
+        plan.twiddleRe[j] = static_cast<float>(cosTable[j]);
+        plan.twiddleIm[j] = static_cast<float>(sinTable[j]);
+    }
+
+    int bits = 0;
+    while ((size_t(1) << bits) < fftSize) ++bits;
+    for (size_t n = 0; n < fftSize; ++n) {
+        uint32_t reversed = 0;
+        for (int b = 0; b < bits; ++b) {
+            if (n & (size_t(1) << b)) reversed |= uint32_t(1) << (bits - 1 - b);
+        }
+        plan.bitReverse[n] = reversed;
+    }
+
+    // Overlap-save computes a circular convolution, so the kernel is reversed to get the correlation used by the other modes.
+    const size_t kernelSize = convolutionKernel.size();
+    for (size_t k = 0; k < fftSize; ++k) {
+        double sumRe = 0.0;
+        double sumIm = 0.0;
+        for (size_t j = 0; j < kernelSize; ++j) {
+            const double h = convolutionKernel[kernelSize - 1 - j];
+            const size_t idx = (j * k) % fftSize;
+            sumRe += h * cosTable[idx];
+            sumIm += h * sinTable[idx];
+        }
+        plan.kernelRe[k] = static_cast<float>(sumRe / fftSize);
+        plan.kernelIm[k] = static_cast<float>(sumIm / fftSize);
+    }
+
+    return plan;
+}
+
+/**
+ * In-register 4x4 transpose (samples of 4 channels <-> 4 samples per channel).
+ */
+inline void fft_transpose4(float32x4_t& r0, float32x4_t& r1, float32x4_t& r2, float32x4_t& r3) {
+    const float32x4_t t0 = vtrn1q_f32(r0, r1);
+    const float32x4_t t1 = vtrn2q_f32(r0, r1);
+    const float32x4_t t2 = vtrn1q_f32(r2, r3);
+    const float32x4_t t3 = vtrn2q_f32(r2, r3);
+
+    r0 = vreinterpretq_f32_f64(vtrn1q_f64(vreinterpretq_f64_f32(t0), vreinterpretq_f64_f32(t2)));
+    r1 = vreinterpretq_f32_f64(vtrn1q_f64(vreinterpretq_f64_f32(t1), vreinterpretq_f64_f32(t3)));
+    r2 = vreinterpretq_f32_f64(vtrn2q_f64(vreinterpretq_f64_f32(t0), vreinterpretq_f64_f32(t2)));
+    r3 = vreinterpretq_f32_f64(vtrn2q_f64(vreinterpretq_f64_f32(t1), vreinterpretq_f64_f32(t3)));
+}
+
+/**
+ * Iterative radix-2 DIT FFT over Neon lanes (every lane is an independent transform).
+ * Expects the input in bit-reversed order, produces the spectrum in natural order.
+ */
+inline void fft_radix2(float32x4_t* __restrict re, float32x4_t* __restrict im, const FftPlan& plan) {
+    const size_t n = plan.size;
+
+    // First stage has only trivial twiddles.
+    for (size_t a = 0; a < n; a += 2) {
+        const float32x4_t r = re[a + 1];
+        const float32x4_t i = im[a + 1];
+        re[a + 1] = vsubq_f32(re[a], r);
+        im[a + 1] = vsubq_f32(im[a], i);
+        re[a] = vaddq_f32(re[a], r);
+        im[a] = vaddq_f32(im[a], i);
+    }
+
+    for (size_t len = 4; len <= n; len <<= 1) {
+        const size_t half = len / 2;
+        const size_t step = n / len;
+
+        for (size_t start = 0; start < n; start += len) {
+            for (size_t j = 0; j < half; ++j) {
+                const float wr = plan.twiddleRe[j * step];
+                const float wi = plan.twiddleIm[j * step];
+                const size_t a = start + j;
+                const size_t b = a + half;
+
+                const float32x4_t tr = vfmsq_f32(vmulq_n_f32(re[b], wr), im[b], vdupq_n_f32(wi));
+                const float32x4_t ti = vfmaq_n_f32(vmulq_n_f32(re[b], wi), im[b], wr);
+
+                re[b] = vsubq_f32(re[a], tr);
+                im[b] = vsubq_f32(im[a], ti);
+                re[a] = vaddq_f32(re[a], tr);
+                im[a] = vaddq_f32(im[a], ti);
+            }
+        }
+    }
+}
+
+// Shortest length of the present lanes (missing channels are nullptr), below it all 4 lanes are in range.
+template <typename T>
+inline size_t fft_common_length(T* const* channels, const size_t* lengths) {
+    size_t common = SIZE_MAX;
+    for (int c = 0; c < 4; ++c) {
+        if (channels[c]) common = std::min(common, lengths[c]);
+    }
+    return common;
+}
+
+/**
+ * Loads one block of 4 channels into the lanes of a complex component, in bit-reversed order.
+ * Every lane has its own length (channels of different sampling rates), samples past the end of
+ * a channel (and missing channels) are zero.
+ */
+inline void fft_gather(const float* const* channels, const size_t* channelLengths, const size_t blockStart, float32x4_t* __restrict dst, const FftPlan& plan) {
+    const size_t n = plan.size;
+    const uint32_t* rev = plan.bitReverse.data();
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const size_t commonLength = fft_common_length(channels, channelLengths);
+
+    for (size_t i = 0; i < n; i += 4) {
+        const size_t pos = blockStart + i;
+
+        if (pos + 4 <= commonLength) {
+            float32x4_t r0 = channels[0] ? vld1q_f32(channels[0] + pos) : zero;
+            float32x4_t r1 = channels[1] ? vld1q_f32(channels[1] + pos) : zero;
+            float32x4_t r2 = channels[2] ? vld1q_f32(channels[2] + pos) : zero;
+            float32x4_t r3 = channels[3] ? vld1q_f32(channels[3] + pos) : zero;
+            fft_transpose4(r0, r1, r2, r3);
+
+            dst[rev[i + 0]] = r0;
+            dst[rev[i + 1]] = r1;
+            dst[rev[i + 2]] = r2;
+            dst[rev[i + 3]] = r3;
+        } else {
+            for (size_t t = 0; t < 4; ++t) {
+                float lanes[4];
+                for (int c = 0; c < 4; ++c) {
+                    lanes[c] = (channels[c] && pos + t < channelLengths[c]) ? channels[c][pos + t] : 0.0f;
+                }
+                dst[rev[i + t]] = vld1q_f32(lanes);
+            }
+        }
+    }
+}
+
+/**
+ * Stores the valid (non-aliased) part of one block back to 4 output channels, each with its own output length.
+ */
+inline void fft_scatter(const float32x4_t* __restrict src, const size_t validStart, float* const* channels, const size_t outputStart, const size_t* outputLengths, const FftPlan& plan) {
+    const size_t n = plan.size;
+    const size_t commonLength = fft_common_length(channels, outputLengths);
+    size_t i = validStart;
+    size_t pos = outputStart;
+
+    for (; i + 4 <= n && pos + 4 <= commonLength; i += 4, pos += 4) {
+        float32x4_t r0 = src[i + 0];
+        float32x4_t r1 = src[i + 1];
+        float32x4_t r2 = src[i + 2];
+        float32x4_t r3 = src[i + 3];
+        fft_transpose4(r0, r1, r2, r3);
+
+        if (channels[0]) vst1q_f32(channels[0] + pos, r0);
+        if (channels[1]) vst1q_f32(channels[1] + pos, r1);
+        if (channels[2]) vst1q_f32(channels[2] + pos, r2);
+        if (channels[3]) vst1q_f32(channels[3] + pos, r3);
+    }
+
+    for (; i < n; ++i, ++pos) {
+        float lanes[4];
+        vst1q_f32(lanes, src[i]);
+        for (int c = 0; c < 4; ++c) {
+            if (channels[c] && pos < outputLengths[c]) channels[c][pos] = lanes[c];
+        }
+    }
+}
+
+/**
+ * Parallel channel-batched FFT convolution (overlap-save).
+ *
+ * All channels share the kernel, so its spectrum is computed once. Eight channels form a batch:
+ * four are placed into the Neon lanes of the real part and four into the imaginary part of one complex
+ * signal. Because the kernel is real, the real and imaginary parts of the inverse transform are exactly
+ * the filtered channels, which halves the number of transforms compared to per-channel real FFTs.
+ * The inverse transform reuses the forward one via conjugation. Every GCD task processes
+ * a run of blocks of one batch and reuses its workspace.
+ * Channels are batched in order of decreasing length, so channels sampled at the same rate share a batch
+ * and no lanes idle while the longest channel of a batch is still being transformed.
+ *
+ * @tparam Radius Kernel radius.
+ * @tparam FftSize FFT length (power of two), every block yields FftSize - 2 * Radius outputs per channel.
+ * @param data Loaded EDF data (channel layout and padded samples).
+ */
+template <int Radius, int FftSize>
+void convolve_par_fft_batched(const EdfData& data, NeonVector& outputBuffer, const std::vector<float>& convolutionKernel) {
+    static_assert((FftSize & (FftSize - 1)) == 0, "FftSize must be a power of two.");
+    static_assert(FftSize > 2 * Radius + 4, "FftSize must exceed the kernel size.");
+
+    constexpr size_t BatchChannels = 8;
+    constexpr size_t BlocksPerTask = 8;
+    constexpr size_t BlockOutputs = FftSize - 2 * Radius;
+
+    const FftPlan plan = create_fft_plan(convolutionKernel, FftSize);
+    const FftPlan* planPtr = &plan;
+
+    const size_t numChannels = static_cast<size_t>(data.header.num_signals);
+    std::vector<size_t> order(numChannels);
+    for (size_t c = 0; c < numChannels; ++c) order[c] = c;
+    std::stable_sort(order.begin(), order.end(), [&data](size_t a, size_t b) { return data.channelLengths[a] > data.channelLengths[b]; });
+
+    // One task per run of BlocksPerTask blocks of a batch, the longest channel of the batch sets its block count.
+    const size_t numBatches = (numChannels + BatchChannels - 1) / BatchChannels;
+    std::vector<size_t> taskBatch;
+    std::vector<size_t> taskFirstBlock;
+    for (size_t batch = 0; batch < numBatches; ++batch) {
+        const size_t blocks = (static_cast<size_t>(data.channelLengths[order[batch * BatchChannels]]) + BlockOutputs - 1) / BlockOutputs;
+        for (size_t block = 0; block < blocks; block += BlocksPerTask) {
+            taskBatch.push_back(batch);
+            taskFirstBlock.push_back(block);
+        }
+    }
+
+    const float* dataPtr = data.samples.data();
+    float* outputPtr = outputBuffer.data();
+    const EdfData* edfPtr = &data;
+    const size_t* orderPtr = order.data();
+    const size_t* taskBatchPtr = taskBatch.data();
+    const size_t* taskFirstBlockPtr = taskFirstBlock.data();
+
+    dispatch_apply(taskBatch.size(), dispatch_get_global_queue(QOS_CLASS_USER_INTERACTIVE, 0), ^(size_t taskIndex) {
+        const size_t batch = taskBatchPtr[taskIndex];
+        const size_t firstBlock = taskFirstBlockPtr[taskIndex];
+
+        const float* inChannels[BatchChannels];
+        float* outChannels[BatchChannels];
+        size_t channelLengths[BatchChannels];
+        size_t outputLengths[BatchChannels];
+        size_t longestOutput = 0;
+        for (size_t c = 0; c < BatchChannels; ++c) {
+            const size_t slot = batch * BatchChannels + c;
+            const bool present = slot < numChannels;
+            const size_t channel = present ? orderPtr[slot] : 0;
+            inChannels[c] = present ? dataPtr + edfPtr->channelStarts[channel] : nullptr;
+            outChannels[c] = present ? outputPtr + edfPtr->channelStarts[channel] : nullptr;
+            channelLengths[c] = present ? edfPtr->channel_length_padded(channel) : 0;
+            outputLengths[c] = present ? static_cast<size_t>(edfPtr->channelLengths[channel]) : 0;
+            longestOutput = std::max(longestOutput, outputLengths[c]);
+        }
+        const size_t lastBlock = std::min(firstBlock + BlocksPerTask, (longestOutput + BlockOutputs - 1) / BlockOutputs);
+
+        std::vector<float32x4_t> re(FftSize);
+        std::vector<float32x4_t> im(FftSize);
+        std::vector<float32x4_t> productRe(FftSize);
+        std::vector<float32x4_t> productIm(FftSize);
+
+        const float* kernelRe = planPtr->kernelRe.data();
+        const float* kernelIm = planPtr->kernelIm.data();
+        const uint32_t* rev = planPtr->bitReverse.data();
+
+        for (size_t block = firstBlock; block < lastBlock; ++block) {
+            const size_t blockStart = block * BlockOutputs;
+
+            fft_gather(inChannels, channelLengths, blockStart, re.data(), *planPtr);
+            fft_gather(inChannels + 4, channelLengths + 4, blockStart, im.data(), *planPtr);
+            fft_radix2(re.data(), im.data(), *planPtr);
+
+            // Multiply by the kernel spectrum and conjugate, written in bit-reversed order for the inverse transform.
+            for (size_t k = 0; k < FftSize; ++k) {
+                const float32x4_t a = re[k];
+                const float32x4_t b = im[k];
+                productRe[rev[k]] = vfmsq_f32(vmulq_n_f32(a, kernelRe[k]), b, vdupq_n_f32(kernelIm[k]));
+                productIm[rev[k]] = vnegq_f32(vfmaq_n_f32(vmulq_n_f32(a, kernelIm[k]), b, kernelRe[k]));
+            }
+
+            fft_radix2(productRe.data(), productIm.data(), *planPtr);
+
+            // conj(FFT(conj(X))) / N is the inverse transform; the real part needs no sign change.
+            for (size_t k = 0; k < FftSize; ++k) productIm[k] = vnegq_f32(productIm[k]);
+
+            fft_scatter(productRe.data(), 2 * Radius, outChannels, blockStart, outputLengths, *planPtr);
+            fft_scatter(productIm.data(), 2 * Radius, outChannels + 4, blockStart, outputLengths + 4, *planPtr);
+        }
+    });
+}
+
+#endif // CONVOLVE_FFT
@@ -0,0 +1,202 @@
+//
+//  convolve_fp16.hpp
+//  EegLinearFilter
+//
+//  Convolution with half-precision (FP16) storage of samples and outputs and FP32 accumulation.
+//
+
+#ifndef CONVOLVE_FP16
+#define CONVOLVE_FP16
+
+#include "../data_types.hpp"
+#include "../half_precision.hpp"
+#include <dispatch/dispatch.h>
+#include <arm_neon.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+/**
+ * Loads 16 consecutive FP16 samples widened to four FP32 vectors.
+ */
+inline void fp16_load16(const float16_t* __restrict p, float32x4_t& a, float32x4_t& b, float32x4_t& c, float32x4_t& d) {
+    const float16x8_t lo = vld1q_f16(p);
+    const float16x8_t hi = vld1q_f16(p + 8);
+    a = vcvt_f32_f16(vget_low_f16(lo));
+    b = vcvt_high_f32_f16(lo);
+    c = vcvt_f32_f16(vget_low_f16(hi));
+    d = vcvt_high_f32_f16(hi);
+}
+
+/**
+ * Convolves one chunk: FP16 samples are widened in registers, the sums are kept in an FP32
+ * accumulator (one chunk, L1 resident) and narrowed to FP16 once all kernel taps are applied.
+ * Shared by the sequential and the parallel mode.
+ *
+ * @tparam KBatch Number of kernel taps applied per pass over the chunk.
+ * @param accumulator FP32 workspace of at least actualChunkSize elements.
+ */
+template <int KBatch>
+inline void fp16_chunk(const float16_t* __restrict d_chunk, float16_t* __restrict o_chunk, const size_t actualChunkSize, const float* __restrict kernelPtr, const size_t kernelSize, float* __restrict accumulator) {
+    std::fill_n(accumulator, actualChunkSize, 0.0f);
+
+    size_t k = 0;
+    for (; k + KBatch <= kernelSize; k += KBatch) {
+        const float* k_ptr_base = kernelPtr + k;
+        size_t out = 0;
+
+        for (; out + 16 <= actualChunkSize; out += 16) {
+            float32x4_t acc0_A = vdupq_n_f32(0.0f); float32x4_t acc1_A = vdupq_n_f32(0.0f);
+            float32x4_t acc2_A = vdupq_n_f32(0.0f); float32x4_t acc3_A = vdupq_n_f32(0.0f);
+            float32x4_t acc0_B = vdupq_n_f32(0.0f); float32x4_t acc1_B = vdupq_n_f32(0.0f);
+            float32x4_t acc2_B = vdupq_n_f32(0.0f); float32x4_t acc3_B = vdupq_n_f32(0.0f);
+            float32x4_t acc0_C = vdupq_n_f32(0.0f); float32x4_t acc1_C = vdupq_n_f32(0.0f);
+            float32x4_t acc2_C = vdupq_n_f32(0.0f); float32x4_t acc3_C = vdupq_n_f32(0.0f);
+            float32x4_t acc0_D = vdupq_n_f32(0.0f); float32x4_t acc1_D = vdupq_n_f32(0.0f);
+            float32x4_t acc2_D = vdupq_n_f32(0.0f); float32x4_t acc3_D = vdupq_n_f32(0.0f);
+
+            const float16_t* current_d = d_chunk + out + k;
+
+            for (int i = 0; i < KBatch; i += 4) {
+                float32x4_t a, b, c, d;
+
+                fp16_load16(current_d + i + 0, a, b, c, d);
+                acc0_A = vfmaq_n_f32(acc0_A, a, k_ptr_base[i + 0]); acc0_B = vfmaq_n_f32(acc0_B, b, k_ptr_base[i + 0]);
+                acc0_C = vfmaq_n_f32(acc0_C, c, k_ptr_base[i + 0]); acc0_D = vfmaq_n_f32(acc0_D, d, k_ptr_base[i + 0]);
+
+                fp16_load16(current_d + i + 1, a, b, c, d);
+                acc1_A = vfmaq_n_f32(acc1_A, a, k_ptr_base[i + 1]); acc1_B = vfmaq_n_f32(acc1_B, b, k_ptr_base[i + 1]);
+                acc1_C = vfmaq_n_f32(acc1_C, c, k_ptr_base[i + 1]); acc1_D = vfmaq_n_f32(acc1_D, d, k_ptr_base[i + 1]);
+
+                fp16_load16(current_d + i + 2, a, b, c, d);
+                acc2_A = vfmaq_n_f32(acc2_A, a, k_ptr_base[i + 2]); acc2_B = vfmaq_n_f32(acc2_B, b, k_ptr_base[i + 2]);
+                acc2_C = vfmaq_n_f32(acc2_C, c, k_ptr_base[i + 2]); acc2_D = vfmaq_n_f32(acc2_D, d, k_ptr_base[i + 2]);
+
+                fp16_load16(current_d + i + 3, a, b, c, d);
+                acc3_A = vfmaq_n_f32(acc3_A, a, k_ptr_base[i + 3]); acc3_B = vfmaq_n_f32(acc3_B, b, k_ptr_base[i + 3]);
+                acc3_C = vfmaq_n_f32(acc3_C, c, k_ptr_base[i + 3]); acc3_D = vfmaq_n_f32(acc3_D, d, k_ptr_base[i + 3]);
+            }
+
+            float* o = accumulator + out;
+            vst1q_f32(o + 0, vaddq_f32(vld1q_f32(o + 0), vaddq_f32(vaddq_f32(acc0_A, acc1_A), vaddq_f32(acc2_A, acc3_A))));
+            vst1q_f32(o + 4, vaddq_f32(vld1q_f32(o + 4), vaddq_f32(vaddq_f32(acc0_B, acc1_B), vaddq_f32(acc2_B, acc3_B))));
+            vst1q_f32(o + 8, vaddq_f32(vld1q_f32(o + 8), vaddq_f32(vaddq_f32(acc0_C, acc1_C), vaddq_f32(acc2_C, acc3_C))));
+            vst1q_f32(o + 12, vaddq_f32(vld1q_f32(o + 12), vaddq_f32(vaddq_f32(acc0_D, acc1_D), vaddq_f32(acc2_D, acc3_D))));
+        }
+
+        for (; out < actualChunkSize; ++out) {
+            float acc = 0.0f;
+            const float16_t* current_d = d_chunk + out + k;
+            for (int i = 0; i < KBatch; ++i) acc += static_cast<float>(current_d[i]) * k_ptr_base[i];
+            accumulator[out] += acc;
+        }
+    }
+
+    for (; k < kernelSize; ++k) {
+        const float kv = kernelPtr[k];
+        const float16_t* current_d = d_chunk + k;
+        size_t out = 0;
+
+        for (; out + 16 <= actualChunkSize; out += 16) {
+            float32x4_t a, b, c, d;
+            fp16_load16(current_d + out, a, b, c, d);
+            float* o = accumulator + out;
+            vst1q_f32(o + 0, vfmaq_n_f32(vld1q_f32(o + 0), a, kv));
+            vst1q_f32(o + 4, vfmaq_n_f32(vld1q_f32(o + 4), b, kv));
+            vst1q_f32(o + 8, vfmaq_n_f32(vld1q_f32(o + 8), c, kv));
+            vst1q_f32(o + 12, vfmaq_n_f32(vld1q_f32(o + 12), d, kv));
+        }
+
+        for (; out < actualChunkSize; ++out) accumulator[out] += static_cast<float>(current_d[out]) * kv;
+    }
+
+    fp16_narrow_range(accumulator, o_chunk, actualChunkSize);
+}
+
+/**
+ * Sequential FP16-storage implementation.
+ *
+ * The loader keeps the samples narrowed to FP16 (SampleFormat::FLOAT16), the kernel reads them and writes
+ * FP16 outputs, so the pass moves half the bytes of the FP32 modes. The outputs are widened into the float
+ * output buffer afterwards for its consumers (accuracy, export); the widening is timed as a CPU memory operation.
+ *
+ * @tparam Radius Kernel radius.
+ * @tparam ChunkSize Elements per block.
+ * @tparam KBatch Kernel taps per pass.
+ * @return ProcessingStats with the conversion and computation times.
+ */
+template <int Radius, int ChunkSize, int KBatch>
+ProcessingStats convolve_seq_fp16(const EdfData& loadedData, NeonVector& outputBuffer, const std::vector<float>& convolutionKernel) {
+    constexpr size_t KernelSize = 2 * Radius + 1;
+    const HalfVector& data = loadedData.halfSamples;
+    const size_t outSize = data.size() - KernelSize + 1;
+
+    auto alloc_start = std::chrono::high_resolution_clock::now();
+    ScratchArray<float16_t> halfOutput(outSize);
+    auto compute_start = std::chrono::high_resolution_clock::now();
+
+    const float16_t* __restrict dataPtr = data.data();
+    float16_t* __restrict outputPtr = halfOutput.data();
+    const float* __restrict kernelPtr = convolutionKernel.data();
+    NeonVector accumulator(ChunkSize);
+
+    for (size_t start = 0; start < outSize; start += ChunkSize) {
+        const size_t actualChunkSize = std::min(static_cast<size_t>(ChunkSize), outSize - start);
+        fp16_chunk<KBatch>(dataPtr + start, outputPtr + start, actualChunkSize, kernelPtr, KernelSize, accumulator.data());
+    }
+    auto compute_end = std::chrono::high_resolution_clock::now();
+
+    fp16_widen_range(halfOutput.data(), outputBuffer.data(), outSize);
+    auto widen_end = std::chrono::high_resolution_clock::now();
+
+    const double compute = std::chrono::duration<double>(compute_end - compute_start).count();
+    const double memory = std::chrono::duration<double>(compute_start - alloc_start).count() + std::chrono::duration<double>(widen_end - compute_end).count();
+    return { compute + memory, compute, 0.0, memory, 0.0 };
+}
+
+/**
+ * Parallel FP16-storage implementation (chunks and the widening are spread across cores).
+ *
+ * @tparam Radius Kernel radius.
+ * @tparam ChunkSize Elements per GCD task.
+ * @tparam KBatch Kernel taps per pass.
+ * @return ProcessingStats with the conversion and computation times.
+ */
+template <int Radius, int ChunkSize, int KBatch>
+ProcessingStats convolve_par_fp16(const EdfData& loadedData, NeonVector& outputBuffer, const std::vector<float>& convolutionKernel) {
+    constexpr size_t KernelSize = 2 * Radius + 1;
+    const HalfVector& data = loadedData.halfSamples;
+    const size_t outSize = data.size() - KernelSize + 1;
+    const size_t numChunks = (outSize + ChunkSize - 1) / ChunkSize;
+
+    auto alloc_start = std::chrono::high_resolution_clock::now();
+    ScratchArray<float16_t> halfOutput(outSize);
+    auto compute_start = std::chrono::high_resolution_clock::now();
+
+    const float16_t* __restrict dataPtr = data.data();
+    float16_t* __restrict outputPtr = halfOutput.data();
+    const float* __restrict kernelPtr = convolutionKernel.data();
+
+    dispatch_apply(numChunks, dispatch_get_global_queue(QOS_CLASS_USER_INTERACTIVE, 0), ^(size_t chunkIndex) {
+        const size_t start = chunkIndex * ChunkSize;
+        const size_t actualChunkSize = std::min(static_cast<size_t>(ChunkSize), outSize - start);
+
+        alignas(64) float accumulator[ChunkSize];
+        fp16_chunk<KBatch>(dataPtr + start, outputPtr + start, actualChunkSize, kernelPtr, KernelSize, accumulator);
+    });
+    auto compute_end = std::chrono::high_resolution_clock::now();
+
+    float* __restrict widenPtr = outputBuffer.data();
+    dispatch_apply(numChunks, dispatch_get_global_queue(QOS_CLASS_USER_INTERACTIVE, 0), ^(size_t chunkIndex) {
+        const size_t start = chunkIndex * ChunkSize;
+        const size_t count = std::min(static_cast<size_t>(ChunkSize), outSize - start);
+        fp16_widen_range(outputPtr + start, widenPtr + start, count);
+    });
+    auto widen_end = std::chrono::high_resolution_clock::now();
+
+    const double compute = std::chrono::duration<double>(compute_end - compute_start).count();
+    const double memory = std::chrono::duration<double>(compute_start - alloc_start).count() + std::chrono::duration<double>(widen_end - compute_end).count();
+    return { compute + memory, compute, 0.0, memory, 0.0 };
+}
+
+#endif // CONVOLVE_FP16
@@ -0,0 +1,93 @@
+//
+//  convolve_fused.hpp
+//  EegLinearFilter
+//
+//  Fused decode-and-filter: tiles read raw int16 samples straight from the mmapped EDF data records.
+//
+
+#ifndef CONVOLVE_FUSED
+#define CONVOLVE_FUSED
+
+#include "../data_types.hpp"
+#include "../io/edf_records.hpp"
+#include "convolve_toeplitz.hpp"
+#include <dispatch/dispatch.h>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * Parallel fused decode-and-filter implementation.
+ *
+ * The recording is not decoded up front (EdfData::samples may be empty). Every GCD task maps
+ * its window of one channel (chunk + kernel halo) from the data records, decodes it in Neon registers
+ * into a small L1/L2-resident tile and filters it with the Toeplitz-GEMM micro-kernel. The border
+ * padding is reproduced by clamping the window to the first/last sample of the channel.
+ * The full float copy of the input and its memory sweep disappear.
+ * With a record output the filtered tile is quantized straight into the EDF records, so the float
+ * output buffer is not touched either.
+ *
+ * @tparam Radius Kernel radius.
+ * @tparam ChunkSize Outputs per GCD task.
+ * @tparam MR Number of Neon accumulators in the micro-kernel.
+ * @param records Optional EDF record output (nullptr writes physical values to outputBuffer).
+ * @throws std::runtime_error if the file cannot be mapped or is shorter than its header declares.
+ */
+template <int Radius, int ChunkSize, int MR>
+void convolve_par_fused_decode(const EdfData& data, NeonVector& outputBuffer, const std::vector<float>& convolutionKernel, EdfRecordOutput* records = nullptr) {
+    constexpr size_t KernelSize = 2 * Radius + 1;
+
+    const MappedFile mapped(data.records.filePath);
+    const size_t requiredBytes = data.records.headerSize + static_cast<size_t>(data.records.recordCount) * data.records.recordSize * sizeof(int16_t);
+    if (mapped.size < requiredBytes) {
+        throw std::runtime_error("EDF file is shorter than its data records");
+    }
+
+    const ToeplitzPanels panels = pack_toeplitz_panels<MR>(convolutionKernel);
+    const ToeplitzPanels* panelsPtr = &panels;
+
+    const std::vector<ChannelChunk> chunks = split_channel_chunks(data, KernelSize, ChunkSize);
+    // The micro-kernel reads whole 4-tap groups past the window, the tail of the tile stays zero.
+    const size_t tileCapacity = ChunkSize + 4 * panels.groups + 4;
+
+    const uint8_t* fileData = mapped.data;
+    const EdfData* dataPtr = &data;
+    float* __restrict outputPtr = outputBuffer.data();
+    const float* __restrict kernelPtr = convolutionKernel.data();
+    const ChannelChunk* chunksPtr = chunks.data();
+
+    dispatch_apply(chunks.size(), dispatch_get_global_queue(QOS_CLASS_USER_INTERACTIVE, 0), ^(size_t taskIndex) {
+        const int c = chunksPtr[taskIndex].channel;
+        const size_t start = chunksPtr[taskIndex].start;
+        const size_t actualChunkSize = chunksPtr[taskIndex].count;
+        const size_t signalLength = static_cast<size_t>(dataPtr->channelLengths[c]);
+
+        const EdfChannelParams& channel = dataPtr->channels[c];
+        const float scale = static_cast<float>(channel.scale);
+        const float offset = static_cast<float>(channel.offset);
+
+        std::vector<float> tile(tileCapacity, 0.0f);
+
+        // Padded index p corresponds to signal sample p - Radius (clamped to the signal).
+        const long long windowFirst = static_cast<long long>(start) - Radius;
+        const long long windowEnd = windowFirst + static_cast<long long>(actualChunkSize + KernelSize - 1);
+        const long long decodeFirst = std::max(windowFirst, 0LL);
+        const long long decodeEnd = std::min(windowEnd, static_cast<long long>(signalLength));
+
+        float* decodeDst = tile.data() + (decodeFirst - windowFirst);
+        decode_channel_range(fileData, dataPtr->records, c, channel.smp_in_datarecord, static_cast<size_t>(decodeFirst), static_cast<size_t>(decodeEnd - decodeFirst), decodeDst, scale, offset);
+
+        std::fill(tile.data(), decodeDst, decodeDst[0]);
+        std::fill(decodeDst + (decodeEnd - decodeFirst), tile.data() + (windowEnd - windowFirst), decodeDst[decodeEnd - decodeFirst - 1]);
+
+        if (records) {
+            std::vector<float> filtered(actualChunkSize);
+            toeplitz_block<MR>(tile.data(), filtered.data(), actualChunkSize, *panelsPtr, kernelPtr, KernelSize);
+            emit_tile_to_records(filtered.data(), start, actualChunkSize, c, *dataPtr, *records);
+        } else {
+            toeplitz_block<MR>(tile.data(), outputPtr + dataPtr->channelStarts[c] + start, actualChunkSize, *panelsPtr, kernelPtr, KernelSize);
+        }
+    });
+}
+
+#endif // CONVOLVE_FUSED
@@ -18,16 +18,28 @@
 
 #include "../../config.h"
 #include "../../data_types.hpp"
+#include "../../buffer_pool.hpp"
 #include <vector>
 #include <iostream>
 #include <stdexcept>
 #include <chrono>
 #include <string>
 
+/**
+ * Metal buffer kept alive across dispatches together with the memory it wraps.
+ */
+struct CachedMetalBuffer {
+    const void* pointer = nullptr;
+    size_t bytes = 0;
+    size_t generation = 0;
+    MTL::Buffer* buffer = nullptr;
+};
+
 /**
  * Singleton structure managing the Metal device context.
  * Holds the connection to the GPU (Device), the command submission queue,
- * and pre-compiled pipeline states for the compute kernels.
+ * pre-compiled pipeline states for the compute kernels and the buffers wrapping
+ * the (pooled) input, output and kernel memory, which are reused while it does not change.
  */
 struct MetalContext {
     MTL::Device* device = nullptr;
@@ -36,6 +48,11 @@ struct MetalContext {
     MTL::ComputePipelineState* pipelineStateNaive = nullptr;
     MTL::ComputePipelineState* pipelineState32 = nullptr;
 
+    CachedMetalBuffer dataCache;
+    CachedMetalBuffer outputCache;
+    CachedMetalBuffer kernelCache;
+    std::vector<float> cachedKernel;
+
     MetalContext() {
         device = MTL::CreateSystemDefaultDevice();
         if (!device) {
@@ -80,7 +97,50 @@ struct MetalContext {
         return pso;
     }
     
+    /**
+     * Returns a no-copy buffer wrapping the given memory, re-creating it only when the memory
+     * changed or the buffer pool returned memory to the OS since the wrapper was created.
+     * @param cache Slot holding the previous wrapper.
+     * @param pointer Start of the (page-aligned) memory.
+     * @param bytes Size of the memory in bytes.
+     */
+    MTL::Buffer* wrapBuffer(CachedMetalBuffer& cache, const void* pointer, size_t bytes) {
+        const size_t generation = BufferPool::get().generation();
+        if (cache.buffer && cache.pointer == pointer && cache.bytes == bytes && cache.generation == generation) {
+            return cache.buffer;
+        }
+
+        if (cache.buffer) cache.buffer->release();
+        cache.buffer = device->newBuffer((void*)pointer, bytes, MTL::ResourceStorageModeShared, nullptr);
+        cache.pointer = pointer;
+        cache.bytes = bytes;
+        cache.generation = generation;
+        return cache.buffer;
+    }
+
+    /**
+     * Returns a buffer holding a copy of the kernel weights, uploaded again only when the weights change.
+     * @param convolutionKernel The 1D filter kernel weights.
+     */
+    MTL::Buffer* kernelBuffer(const std::vector<float>& convolutionKernel) {
+        if (kernelCache.buffer && cachedKernel == convolutionKernel) {
+            return kernelCache.buffer;
+        }
+
+        if (kernelCache.buffer) kernelCache.buffer->release();
+        kernelCache.buffer = device->newBuffer(
+            convolutionKernel.data(),
+            convolutionKernel.size() * sizeof(float),
+            MTL::ResourceStorageModeShared
+        );
+        cachedKernel = convolutionKernel;
+        return kernelCache.buffer;
+    }
+
     ~MetalContext() {
+        if (dataCache.buffer) dataCache.buffer->release();
+        if (outputCache.buffer) outputCache.buffer->release();
+        if (kernelCache.buffer) kernelCache.buffer->release();
         if (pipelineStateNaive) pipelineStateNaive->release();
         if (pipelineState32) pipelineState32->release();
         if (commandQueue) commandQueue->release();
@@ -95,7 +155,7 @@ struct MetalContext {
 
 /**
  * Dispatches the "Naive" GPU implementation.
- * Sets up buffers, calculates grid dimensions based on simple tiling, and commits work to the GPU.
+ * Binds the cached buffers, calculates grid dimensions based on simple tiling, and commits work to the GPU.
  *
  * @tparam Radius The kernel radius.
  * @param data Input signal data.
@@ -119,25 +179,9 @@ ProcessingStats convolve_gpu_naive(const NeonVector& data, NeonVector& outputBuf
 
     auto mem_start = std::chrono::high_resolution_clock::now();
     
-    MTL::Buffer* dataBuffer = ctx.device->newBuffer(
-        (void*)data.data(),
-        data.size() * sizeof(float),
-        MTL::ResourceStorageModeShared,
-        nullptr
-    );
-    
-    MTL::Buffer* outBuffer = ctx.device->newBuffer(
-        (void*)outputBuffer.data(),
-        outputBuffer.size() * sizeof(float),
-        MTL::ResourceStorageModeShared,
-        nullptr
-    );
-    
-    MTL::Buffer* kernelBuffer = ctx.device->newBuffer(
-        convolutionKernel.data(),
-        convolutionKernel.size() * sizeof(float),
-        MTL::ResourceStorageModeShared
-    );
+    MTL::Buffer* dataBuffer = ctx.wrapBuffer(ctx.dataCache, data.data(), data.size() * sizeof(float));
+    MTL::Buffer* outBuffer = ctx.wrapBuffer(ctx.outputCache, outputBuffer.data(), outputBuffer.size() * sizeof(float));
+    MTL::Buffer* kernelBuffer = ctx.kernelBuffer(convolutionKernel);
     
     auto mem_end = std::chrono::high_resolution_clock::now();
     double memoryTime = std::chrono::duration<double>(mem_end - mem_start).count();
@@ -176,15 +220,6 @@ ProcessingStats convolve_gpu_naive(const NeonVector& data, NeonVector& outputBuf
     double computeTime = gpuEnd - gpuStart;
     if (computeTime < 0) computeTime = 0;
 
-    mem_start = std::chrono::high_resolution_clock::now();
-    
-    dataBuffer->release();
-    outBuffer->release();
-    kernelBuffer->release();
-    
-    mem_end = std::chrono::high_resolution_clock::now();
-    memoryTime += std::chrono::duration<double>(mem_end - mem_start).count();
-    
     auto end_wall = std::chrono::high_resolution_clock::now();
     double totalTime = std::chrono::duration<double>(end_wall - start_wall).count();
 
@@ -199,7 +234,7 @@ ProcessingStats convolve_gpu_naive(const NeonVector& data, NeonVector& outputBuf
 
 /**
  * Dispatches the optimized "32-bit" GPU implementation.
- * Sets up buffers, calculates grid dimensions based on tiling config, and commits work to the GPU.
+ * Binds the cached buffers, calculates grid dimensions based on tiling config, and commits work to the GPU.
  *
  * @tparam Radius The kernel radius.
  * @param data Input signal.
@@ -220,25 +255,9 @@ ProcessingStats convolve_gpu(const NeonVector& data, NeonVector& outputBuffer, c
     MetalContext& ctx = MetalContext::get();
     auto mem_start = std::chrono::high_resolution_clock::now();
     
-    MTL::Buffer* dataBuffer = ctx.device->newBuffer(
-        (void*)data.data(),
-        data.size() * sizeof(float),
-        MTL::ResourceStorageModeShared,
-        nullptr
-    );
-    
-    MTL::Buffer* outBuffer = ctx.device->newBuffer(
-        (void*)outputBuffer.data(),
-        outputBuffer.size() * sizeof(float),
-        MTL::ResourceStorageModeShared,
-        nullptr
-    );
-    
-    MTL::Buffer* kernelBuffer = ctx.device->newBuffer(
-        convolutionKernel.data(),
-        convolutionKernel.size() * sizeof(float),
-        MTL::ResourceStorageModeShared
-    );
+    MTL::Buffer* dataBuffer = ctx.wrapBuffer(ctx.dataCache, data.data(), data.size() * sizeof(float));
+    MTL::Buffer* outBuffer = ctx.wrapBuffer(ctx.outputCache, outputBuffer.data(), outputBuffer.size() * sizeof(float));
+    MTL::Buffer* kernelBuffer = ctx.kernelBuffer(convolutionKernel);
     
     auto mem_end = std::chrono::high_resolution_clock::now();
     double memoryTime = std::chrono::duration<double>(mem_end - mem_start).count();
@@ -279,15 +298,6 @@ ProcessingStats convolve_gpu(const NeonVector& data, NeonVector& outputBuffer, c
 
     pool->release();
 
-    mem_start = std::chrono::high_resolution_clock::now();
-
-    dataBuffer->release();
-    outBuffer->release();
-    kernelBuffer->release();
-    
-    mem_end = std::chrono::high_resolution_clock::now();
-    memoryTime += std::chrono::duration<double>(mem_end - mem_start).count();
-    
     auto end_wall = std::chrono::high_resolution_clock::now();
     double totalTime = std::chrono::duration<double>(end_wall - start_wall).count();
 
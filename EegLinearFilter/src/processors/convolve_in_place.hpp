@@ -0,0 +1,128 @@
+//
+//  convolve_in_place.hpp
+//  EegLinearFilter
+//
+//  Parallel convolution overwriting its input, with per-chunk boundary history.
+//
+
+#ifndef CONVOLVE_IN_PLACE
+#define CONVOLVE_IN_PLACE
+
+#include "../data_types.hpp"
+#include <dispatch/dispatch.h>
+#include <arm_neon.h>
+#include <algorithm>
+#include <vector>
+
+/**
+ * Convolves count outputs from src into dst, where dst may alias src (dst <= src).
+ * Every block of 16 outputs keeps the whole kernel sum in registers and is stored only after all of its
+ * inputs were read, so a left-to-right sweep never reads a sample it has already overwritten.
+ * Two accumulators per output vector (even / odd taps) hide the FMA latency.
+ */
+inline void in_place_block(const float* src, float* dst, const size_t count, const float* __restrict kernelPtr, const size_t kernelSize) {
+    size_t out = 0;
+
+    for (; out + 16 <= count; out += 16) {
+        float32x4_t acc0_A = vdupq_n_f32(0.0f); float32x4_t acc1_A = vdupq_n_f32(0.0f);
+        float32x4_t acc0_B = vdupq_n_f32(0.0f); float32x4_t acc1_B = vdupq_n_f32(0.0f);
+        float32x4_t acc0_C = vdupq_n_f32(0.0f); float32x4_t acc1_C = vdupq_n_f32(0.0f);
+        float32x4_t acc0_D = vdupq_n_f32(0.0f); float32x4_t acc1_D = vdupq_n_f32(0.0f);
+
+        const float* current_d = src + out;
+        size_t k = 0;
+
+        for (; k + 2 <= kernelSize; k += 2) {
+            const float32x4_t k0 = vdupq_n_f32(kernelPtr[k]);
+            const float32x4_t k1 = vdupq_n_f32(kernelPtr[k + 1]);
+
+            acc0_A = vfmaq_f32(acc0_A, vld1q_f32(current_d + k + 0), k0);
+            acc0_B = vfmaq_f32(acc0_B, vld1q_f32(current_d + k + 4), k0);
+            acc0_C = vfmaq_f32(acc0_C, vld1q_f32(current_d + k + 8), k0);
+            acc0_D = vfmaq_f32(acc0_D, vld1q_f32(current_d + k + 12), k0);
+
+            acc1_A = vfmaq_f32(acc1_A, vld1q_f32(current_d + k + 1), k1);
+            acc1_B = vfmaq_f32(acc1_B, vld1q_f32(current_d + k + 5), k1);
+            acc1_C = vfmaq_f32(acc1_C, vld1q_f32(current_d + k + 9), k1);
+            acc1_D = vfmaq_f32(acc1_D, vld1q_f32(current_d + k + 13), k1);
+        }
+
+        if (k < kernelSize) {
+            const float32x4_t k0 = vdupq_n_f32(kernelPtr[k]);
+            acc0_A = vfmaq_f32(acc0_A, vld1q_f32(current_d + k + 0), k0);
+            acc0_B = vfmaq_f32(acc0_B, vld1q_f32(current_d + k + 4), k0);
+            acc0_C = vfmaq_f32(acc0_C, vld1q_f32(current_d + k + 8), k0);
+            acc0_D = vfmaq_f32(acc0_D, vld1q_f32(current_d + k + 12), k0);
+        }
+
+        vst1q_f32(dst + out + 0, vaddq_f32(acc0_A, acc1_A));
+        vst1q_f32(dst + out + 4, vaddq_f32(acc0_B, acc1_B));
+        vst1q_f32(dst + out + 8, vaddq_f32(acc0_C, acc1_C));
+        vst1q_f32(dst + out + 12, vaddq_f32(acc0_D, acc1_D));
+    }
+
+    for (; out < count; ++out) {
+        float sum = 0.0f;
+        for (size_t k = 0; k < kernelSize; ++k) sum += src[out + k] * kernelPtr[k];
+        dst[out] = sum;
+    }
+}
+
+/**
+ * Parallel implementation that overwrites its input with the result (output i is stored at index i),
+ * so filtering needs no second dataset-sized buffer.
+ *
+ * Output i depends on samples [i, i + 2 * Radius], so within a chunk the left-to-right sweep is safe.
+ * Across chunks it is not: the last 2 * Radius outputs of a chunk read the first 2 * Radius samples of the next
+ * chunk, which its own task may already have overwritten. The first pass therefore saves that unmodified
+ * left-edge history of every chunk (2 * Radius floats each). In the second pass every chunk filters
+ * all but its last 2 * Radius outputs in place, then computes those from its own tail and the history
+ * of its right neighbour.
+ *
+ * @tparam Radius Kernel radius.
+ * @tparam ChunkSize Outputs per GCD task (at least 2 * Radius).
+ * @param signal Padded input signal, replaced by the filtered output.
+ */
+template <int Radius, int ChunkSize>
+void convolve_par_in_place(NeonVector& signal, const std::vector<float>& convolutionKernel) {
+    static_assert(ChunkSize >= 2 * Radius, "ChunkSize must cover the boundary history (2 * Radius samples).");
+
+    constexpr size_t KernelSize = 2 * Radius + 1;
+    constexpr size_t HistorySize = 2 * Radius;
+    const size_t outSize = signal.size() - KernelSize + 1;
+    const size_t numChunks = (outSize + ChunkSize - 1) / ChunkSize;
+
+    float* signalPtr = signal.data();
+    const float* __restrict kernelPtr = convolutionKernel.data();
+
+    // Boundary exchange: chunk c + 1 publishes its unmodified left edge, chunk c consumes it.
+    std::vector<float> history(numChunks * HistorySize);
+    float* historyPtr = history.data();
+
+    dispatch_apply(numChunks, dispatch_get_global_queue(QOS_CLASS_USER_INTERACTIVE, 0), ^(size_t chunkIndex) {
+        const float* edge = signalPtr + chunkIndex * ChunkSize;
+        std::copy(edge, edge + HistorySize, historyPtr + chunkIndex * HistorySize);
+    });
+
+    dispatch_apply(numChunks, dispatch_get_global_queue(QOS_CLASS_USER_INTERACTIVE, 0), ^(size_t chunkIndex) {
+        const size_t start = chunkIndex * ChunkSize;
+        const size_t actualChunkSize = std::min(static_cast<size_t>(ChunkSize), outSize - start);
+        float* chunk = signalPtr + start;
+
+        // The last chunk reads the trailing padding, which no task overwrites.
+        if (chunkIndex + 1 == numChunks) {
+            in_place_block(chunk, chunk, actualChunkSize, kernelPtr, KernelSize);
+            return;
+        }
+
+        const size_t bodySize = actualChunkSize - HistorySize;
+        in_place_block(chunk, chunk, bodySize, kernelPtr, KernelSize);
+
+        float window[2 * HistorySize];
+        std::copy(chunk + bodySize, chunk + actualChunkSize, window);
+        std::copy(historyPtr + (chunkIndex + 1) * HistorySize, historyPtr + (chunkIndex + 2) * HistorySize, window + HistorySize);
+        in_place_block(window, chunk + bodySize, HistorySize, kernelPtr, KernelSize);
+    });
+}
+
+#endif // CONVOLVE_IN_PLACE
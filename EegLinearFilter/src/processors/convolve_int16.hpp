@@ -0,0 +1,179 @@
+//
+//  convolve_int16.hpp
+//  EegLinearFilter
+//
+//  Fixed-point convolution of raw EDF digital samples (int16 samples and weights, int32 accumulation).
+//
+
+#ifndef CONVOLVE_INT16
+#define CONVOLVE_INT16
+
+#include "../data_types.hpp"
+#include "../convolution_kernels.hpp"
+#include "../io/edf_records.hpp"
+#include <dispatch/dispatch.h>
+#include <arm_neon.h>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * Linear mapping of the int32 sums of one channel to physical output values.
+ * The kernel Q format and the channel's scale/offset are merged, so they are applied once per output.
+ */
+struct Int16OutputScaling {
+    double scale;   // channel scale / 2^fracBits
+    double offset;  // channel offset * sum(weights) / 2^fracBits
+};
+
+/**
+ * Converts the exact int32 sums to physical values. std::fma rounds once, so the result
+ * does not depend on the platform's contraction of multiply-add.
+ */
+inline void int16_store_scaled(const int32_t* sums, float* __restrict o, const size_t count, const Int16OutputScaling scaling) {
+    for (size_t i = 0; i < count; ++i) {
+        o[i] = static_cast<float>(std::fma(static_cast<double>(sums[i]), scaling.scale, scaling.offset));
+    }
+}
+
+/**
+ * Convolves one chunk of one channel. Samples and weights are multiplied with widening
+ * multiply-accumulate (vmlal_s16) into int32 lanes; 32 outputs are kept in registers while the
+ * whole kernel is applied. Integer sums are exact, so the result is bit-exact for any order
+ * of evaluation (and any thread count). Shared by the sequential and the parallel mode.
+ */
+inline void int16_chunk(const int16_t* __restrict d_chunk, float* __restrict o_chunk, const size_t actualChunkSize, const int16_t* __restrict weights, const size_t kernelSize, const Int16OutputScaling scaling) {
+    size_t out = 0;
+
+    for (; out + 32 <= actualChunkSize; out += 32) {
+        int32x4_t acc0 = vdupq_n_s32(0); int32x4_t acc1 = vdupq_n_s32(0);
+        int32x4_t acc2 = vdupq_n_s32(0); int32x4_t acc3 = vdupq_n_s32(0);
+        int32x4_t acc4 = vdupq_n_s32(0); int32x4_t acc5 = vdupq_n_s32(0);
+        int32x4_t acc6 = vdupq_n_s32(0); int32x4_t acc7 = vdupq_n_s32(0);
+
+        const int16_t* current_d = d_chunk + out;
+
+        for (size_t k = 0; k < kernelSize; ++k) {
+            const int16_t w = weights[k];
+            const int16x8_t v0 = vld1q_s16(current_d + k + 0);
+            const int16x8_t v1 = vld1q_s16(current_d + k + 8);
+            const int16x8_t v2 = vld1q_s16(current_d + k + 16);
+            const int16x8_t v3 = vld1q_s16(current_d + k + 24);
+
+            acc0 = vmlal_n_s16(acc0, vget_low_s16(v0), w); acc1 = vmlal_high_n_s16(acc1, v0, w);
+            acc2 = vmlal_n_s16(acc2, vget_low_s16(v1), w); acc3 = vmlal_high_n_s16(acc3, v1, w);
+            acc4 = vmlal_n_s16(acc4, vget_low_s16(v2), w); acc5 = vmlal_high_n_s16(acc5, v2, w);
+            acc6 = vmlal_n_s16(acc6, vget_low_s16(v3), w); acc7 = vmlal_high_n_s16(acc7, v3, w);
+        }
+
+        alignas(16) int32_t sums[32];
+        vst1q_s32(sums + 0, acc0); vst1q_s32(sums + 4, acc1);
+        vst1q_s32(sums + 8, acc2); vst1q_s32(sums + 12, acc3);
+        vst1q_s32(sums + 16, acc4); vst1q_s32(sums + 20, acc5);
+        vst1q_s32(sums + 24, acc6); vst1q_s32(sums + 28, acc7);
+        int16_store_scaled(sums, o_chunk + out, 32, scaling);
+    }
+
+    for (; out < actualChunkSize; ++out) {
+        int32_t sum = 0;
+        for (size_t k = 0; k < kernelSize; ++k) sum += static_cast<int32_t>(d_chunk[out + k]) * weights[k];
+        int16_store_scaled(&sum, o_chunk + out, 1, scaling);
+    }
+}
+
+/**
+ * Quantizes the kernel and prepares the output scaling of every channel.
+ *
+ * @throws std::runtime_error if the digital samples were not loaded.
+ */
+inline std::vector<Int16OutputScaling> prepare_int16_scaling(const EdfData& data, const QuantizedKernel& kernel) {
+    if (data.digitalSamples.empty()) {
+        throw std::runtime_error("Fixed-point modes require digital samples (load with SampleFormat::INT16)");
+    }
+
+    const double qScale = std::ldexp(1.0, -kernel.fracBits);
+    std::vector<Int16OutputScaling> scaling(data.channels.size());
+    for (size_t c = 0; c < data.channels.size(); ++c) {
+        scaling[c].scale = data.channels[c].scale * qScale;
+        scaling[c].offset = data.channels[c].offset * static_cast<double>(kernel.weightSum) * qScale;
+    }
+    return scaling;
+}
+
+/**
+ * Sequential fixed-point implementation working on EdfData::digitalSamples.
+ * Writes the valid outputs of every channel (physical values) to the usual positions of outputBuffer,
+ * or quantizes them chunk by chunk into the EDF records when a record output is given.
+ *
+ * @tparam Radius Kernel radius.
+ * @tparam ChunkSize Elements per block.
+ * @param records Optional EDF record output (nullptr writes physical values to outputBuffer).
+ */
+template <int Radius, int ChunkSize>
+void convolve_seq_int16(const EdfData& data, NeonVector& outputBuffer, const std::vector<float>& convolutionKernel, EdfRecordOutput* records = nullptr) {
+    constexpr size_t KernelSize = 2 * Radius + 1;
+
+    const QuantizedKernel kernel = quantize_kernel(convolutionKernel);
+    const std::vector<Int16OutputScaling> scaling = prepare_int16_scaling(data, kernel);
+
+    std::vector<float> filtered(records ? ChunkSize : 0);
+
+    for (size_t c = 0; c < data.channels.size(); ++c) {
+        const size_t outSize = data.channel_length_padded(c) - KernelSize + 1;
+        const int16_t* __restrict dataPtr = data.digitalSamples.data() + data.channelStarts[c];
+        float* __restrict outputPtr = outputBuffer.data() + data.channelStarts[c];
+
+        for (size_t start = 0; start < outSize; start += ChunkSize) {
+            const size_t actualChunkSize = std::min(static_cast<size_t>(ChunkSize), outSize - start);
+            if (records) {
+                int16_chunk(dataPtr + start, filtered.data(), actualChunkSize, kernel.weights.data(), KernelSize, scaling[c]);
+                emit_tile_to_records(filtered.data(), start, actualChunkSize, static_cast<int>(c), data, *records);
+            } else {
+                int16_chunk(dataPtr + start, outputPtr + start, actualChunkSize, kernel.weights.data(), KernelSize, scaling[c]);
+            }
+        }
+    }
+}
+
+/**
+ * Parallel fixed-point implementation (one GCD task per channel chunk, balanced by samples across channels of different rates).
+ *
+ * @tparam Radius Kernel radius.
+ * @tparam ChunkSize Elements per GCD task.
+ * @param records Optional EDF record output (nullptr writes physical values to outputBuffer).
+ */
+template <int Radius, int ChunkSize>
+void convolve_par_int16(const EdfData& data, NeonVector& outputBuffer, const std::vector<float>& convolutionKernel, EdfRecordOutput* records = nullptr) {
+    constexpr size_t KernelSize = 2 * Radius + 1;
+
+    const QuantizedKernel kernel = quantize_kernel(convolutionKernel);
+    const std::vector<Int16OutputScaling> scaling = prepare_int16_scaling(data, kernel);
+
+    const std::vector<ChannelChunk> chunks = split_channel_chunks(data, KernelSize, ChunkSize);
+
+    const int16_t* __restrict dataPtr = data.digitalSamples.data();
+    float* __restrict outputPtr = outputBuffer.data();
+    const int16_t* __restrict weightsPtr = kernel.weights.data();
+    const Int16OutputScaling* scalingPtr = scaling.data();
+    const ChannelChunk* chunksPtr = chunks.data();
+    const size_t* channelStartsPtr = data.channelStarts.data();
+    const EdfData* edfPtr = &data;
+
+    dispatch_apply(chunks.size(), dispatch_get_global_queue(QOS_CLASS_USER_INTERACTIVE, 0), ^(size_t taskIndex) {
+        const size_t c = static_cast<size_t>(chunksPtr[taskIndex].channel);
+        const size_t start = chunksPtr[taskIndex].start;
+        const size_t actualChunkSize = chunksPtr[taskIndex].count;
+        const size_t channelStart = channelStartsPtr[c];
+
+        if (records) {
+            std::vector<float> filtered(actualChunkSize);
+            int16_chunk(dataPtr + channelStart + start, filtered.data(), actualChunkSize, weightsPtr, KernelSize, scalingPtr[c]);
+            emit_tile_to_records(filtered.data(), start, actualChunkSize, static_cast<int>(c), *edfPtr, *records);
+        } else {
+            int16_chunk(dataPtr + channelStart + start, outputPtr + channelStart + start, actualChunkSize, weightsPtr, KernelSize, scalingPtr[c]);
+        }
+    });
+}
+
+#endif // CONVOLVE_INT16
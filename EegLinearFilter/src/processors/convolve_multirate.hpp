@@ -0,0 +1,242 @@
+//
+//  convolve_multirate.hpp
+//  EegLinearFilter
+//
+//  Multi-rate (pyramid) Gaussian approximation for kernels with very large sigma.
+//
+
+#ifndef CONVOLVE_MULTIRATE
+#define CONVOLVE_MULTIRATE
+
+#include "../data_types.hpp"
+#include "../convolution_kernels.hpp"
+#include "convolve_par.hpp"
+#include <dispatch/dispatch.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+/**
+ * Parameters of the pyramid chosen for a given sigma and tolerance.
+ */
+struct MultirateLevels {
+    int levels;         // Number of decimation (and interpolation) stages.
+    double lowSigma;    // Sigma of the Gaussian applied at the lowest rate (in low-rate samples).
+    int lowRadius;      // Radius of the low-rate Gaussian kernel.
+};
+
+/**
+ * Picks the number of pyramid levels for a Gaussian of the given sigma.
+ *
+ * Every level halves the rate. A level is only added while the Gaussian spectrum at the new
+ * Nyquist frequency stays below the tolerance, so the aliased energy is bounded by it.
+ * The 5-tap binomial anti-alias and interpolation filters have variance 1 at their own rate,
+ * which is subtracted from the Gaussian variance that remains for the low-rate kernel.
+ *
+ * @param sigma Standard deviation of the target Gaussian (in full-rate samples).
+ * @param tolerance Max. Gaussian spectrum magnitude allowed at the decimated Nyquist frequency.
+ * @param dataSize Number of full-rate samples (limits the depth of the pyramid).
+ * @return MultirateLevels with the selected configuration.
+ */
+inline MultirateLevels select_multirate_levels(const double sigma, const double tolerance, const size_t dataSize) {
+    const double maxFactor = M_PI * sigma / std::sqrt(2.0 * std::log(1.0 / tolerance));
+    int levels = (maxFactor >= 2.0) ? static_cast<int>(std::floor(std::log2(maxFactor))) : 0;
+
+    while (levels > 0 && (dataSize >> levels) < 64) {
+        --levels;
+    }
+
+    double lowVariance = 0.0;
+    while (levels > 0) {
+        const double factor = std::ldexp(1.0, 2 * levels);
+        const double filterVariance = 2.0 * (factor - 1.0) / 3.0;
+        lowVariance = (sigma * sigma - filterVariance) / factor;
+        if (lowVariance >= 0.5) break;
+        --levels;
+    }
+
+    if (levels == 0) {
+        return { 0, sigma, 0 };
+    }
+
+    const double lowSigma = std::sqrt(lowVariance);
+    return { levels, lowSigma, static_cast<int>(std::ceil(4.0 * lowSigma)) };
+}
+
+/**
+ * Halves the sampling rate using the binomial [1 4 6 4 1] / 16 anti-alias filter.
+ * Output sample m is centered at input sample 2m, borders are clamped.
+ */
+template <int ChunkSize>
+void multirate_decimate(const float* src, const size_t srcSize, float* dst, const size_t dstSize) {
+    const size_t numChunks = (dstSize + ChunkSize - 1) / ChunkSize;
+
+    dispatch_apply(numChunks, dispatch_get_global_queue(QOS_CLASS_USER_INTERACTIVE, 0), ^(size_t chunkIndex) {
+        const size_t start = chunkIndex * ChunkSize;
+        const size_t end = std::min(start + ChunkSize, dstSize);
+
+        for (size_t m = start; m < end; ++m) {
+            const size_t c = 2 * m;
+            if (c >= 2 && c + 2 < srcSize) {
+                dst[m] = (src[c - 2] + 4.0f * src[c - 1] + 6.0f * src[c] + 4.0f * src[c + 1] + src[c + 2]) * 0.0625f;
+            } else {
+                float sum = 0.0f;
+                const float weights[5] = { 1.0f, 4.0f, 6.0f, 4.0f, 1.0f };
+                for (int j = -2; j <= 2; ++j) {
+                    const long long idx = std::clamp<long long>((long long)c + j, 0, (long long)srcSize - 1);
+                    sum += weights[j + 2] * src[idx];
+                }
+                dst[m] = sum * 0.0625f;
+            }
+        }
+    });
+}
+
+/**
+ * Doubles the sampling rate (zero insertion + [1 4 6 4 1] / 8 interpolation filter, evaluated polyphase).
+ * Writes dstCount samples of the upsampled signal starting at full-rate position dstOffset, borders are clamped.
+ */
+template <int ChunkSize>
+void multirate_interpolate(const float* src, const size_t srcSize, float* dst, const size_t dstOffset, const size_t dstCount) {
+    const size_t numChunks = (dstCount + ChunkSize - 1) / ChunkSize;
+
+    dispatch_apply(numChunks, dispatch_get_global_queue(QOS_CLASS_USER_INTERACTIVE, 0), ^(size_t chunkIndex) {
+        const size_t start = chunkIndex * ChunkSize;
+        const size_t end = std::min(start + ChunkSize, dstCount);
+
+        for (size_t i = start; i < end; ++i) {
+            const size_t p = i + dstOffset;
+            const size_t m = p / 2;
+            const float center = src[std::min(m, srcSize - 1)];
+            const float next = src[std::min(m + 1, srcSize - 1)];
+
+            if (p % 2 == 0) {
+                const float prev = src[(m > 0) ? std::min(m - 1, srcSize - 1) : 0];
+                dst[i] = (prev + 6.0f * center + next) * 0.125f;
+            } else {
+                dst[i] = (center + next) * 0.5f;
+            }
+        }
+    });
+}
+
+/**
+ * Convolves the lowest pyramid level with a short Gaussian (borders are replicated).
+ */
+template <int ChunkSize>
+void multirate_smooth(const NeonVector& src, NeonVector& dst, const std::vector<float>& lowKernel) {
+    const int lowRadius = static_cast<int>(lowKernel.size() / 2);
+    const size_t size = src.size();
+
+    NeonVector padded(size + 2 * lowRadius);
+    std::fill_n(padded.begin(), lowRadius, src.front());
+    std::copy(src.begin(), src.end(), padded.begin() + lowRadius);
+    std::fill_n(padded.begin() + lowRadius + size, lowRadius, src.back());
+
+    const float* __restrict paddedPtr = padded.data();
+    float* __restrict dstPtr = dst.data();
+    const float* __restrict kernelPtr = lowKernel.data();
+    const size_t kernelSize = lowKernel.size();
+    const size_t numChunks = (size + ChunkSize - 1) / ChunkSize;
+
+    dispatch_apply(numChunks, dispatch_get_global_queue(QOS_CLASS_USER_INTERACTIVE, 0), ^(size_t chunkIndex) {
+        const size_t start = chunkIndex * ChunkSize;
+        const size_t actualChunkSize = std::min(static_cast<size_t>(ChunkSize), size - start);
+
+        float* __restrict o_chunk = dstPtr + start;
+        const float* __restrict d_chunk = paddedPtr + start;
+
+        std::fill_n(o_chunk, actualChunkSize, 0.0f);
+        for (size_t k = 0; k < kernelSize; ++k) {
+            const float kv = kernelPtr[k];
+            #pragma clang loop vectorize(enable) interleave_count(4)
+            for (size_t out = 0; out < actualChunkSize; ++out) {
+                o_chunk[out] += d_chunk[out + k] * kv;
+            }
+        }
+    });
+}
+
+/**
+ * Runs the pyramid over the samples of one channel.
+ * The channel is extended by replicated borders as wide as the support of the whole pyramid
+ * (decimation, low-rate kernel and interpolation filters of every level), so the clamped borders
+ * of the levels never reach the outputs.
+ *
+ * @param samples First sample of the channel (without padding).
+ * @param length Number of samples of the channel.
+ * @param dst Output of the channel, dst[i] is centered at samples[i].
+ */
+template <int ChunkSize>
+void multirate_filter_channel(const float* samples, const size_t length, float* dst, const MultirateLevels& config, const std::vector<float>& lowKernel) {
+    const size_t support = static_cast<size_t>(config.lowRadius + 5) << config.levels;
+
+    NeonVector padded(length + 2 * support);
+    std::fill_n(padded.begin(), support, samples[0]);
+    std::copy(samples, samples + length, padded.begin() + support);
+    std::fill_n(padded.begin() + support + length, support, samples[length - 1]);
+
+    std::vector<NeonVector> pyramid(config.levels + 1);
+    const float* src = padded.data();
+    size_t srcSize = padded.size();
+
+    for (int level = 1; level <= config.levels; ++level) {
+        pyramid[level].resize((srcSize + 1) / 2);
+        multirate_decimate<ChunkSize>(src, srcSize, pyramid[level].data(), pyramid[level].size());
+        src = pyramid[level].data();
+        srcSize = pyramid[level].size();
+    }
+
+    NeonVector smoothed(pyramid[config.levels].size());
+    multirate_smooth<ChunkSize>(pyramid[config.levels], smoothed, lowKernel);
+
+    const NeonVector* current = &smoothed;
+    for (int level = config.levels - 1; level >= 1; --level) {
+        multirate_interpolate<ChunkSize>(current->data(), current->size(), pyramid[level].data(), 0, pyramid[level].size());
+        current = &pyramid[level];
+    }
+
+    // The final interpolation writes straight into the output, skipping the border extension.
+    multirate_interpolate<ChunkSize>(current->data(), current->size(), dst, support, length);
+}
+
+/**
+ * Parallel multi-rate Gaussian approximation.
+ *
+ * Every channel is repeatedly decimated by 2 with a binomial anti-alias filter, convolved with
+ * a short Gaussian at the lowest rate and interpolated back to the full rate. The cost per output
+ * sample no longer depends on sigma. Sigma comes from the kernel parameters (the kernel itself is cut
+ * to Radius), the number of levels is chosen from sigma, the tolerance and the shortest channel; when no
+ * level can be used (small sigma), the direct manually vectorized convolution with the kernel is run instead.
+ *
+ * @tparam Radius Kernel radius.
+ * @tparam ChunkSize Elements per GCD task.
+ * @tparam KBatch Unrolling factor of the direct fallback.
+ * @param loadedData Loaded samples and channel layout.
+ * @param sigma Standard deviation of the Gaussian (in samples).
+ * @param tolerance Max. Gaussian spectrum magnitude allowed at the decimated Nyquist frequency.
+ */
+template <int Radius, int ChunkSize, int KBatch>
+void convolve_par_multirate(const EdfData& loadedData, NeonVector& outputBuffer, const std::vector<float>& convolutionKernel, const double sigma, const float tolerance) {
+    size_t shortest = 0;
+    for (const int length : loadedData.channelLengths) {
+        if (length > 0 && (shortest == 0 || static_cast<size_t>(length) < shortest)) shortest = static_cast<size_t>(length);
+    }
+
+    const MultirateLevels config = select_multirate_levels(sigma, tolerance, shortest);
+    if (config.levels == 0) {
+        convolve_par_manual_vec<Radius, ChunkSize, KBatch>(loadedData.samples, outputBuffer, convolutionKernel);
+        return;
+    }
+
+    const std::vector<float> lowKernel = create_gaussian_weights(config.lowSigma, config.lowRadius);
+    // Channels are filtered one by one, every stage is parallel over the samples of the channel.
+    for (size_t c = 0; c < loadedData.channelLengths.size(); ++c) {
+        if (loadedData.channelLengths[c] == 0) continue;
+        const size_t start = loadedData.channelStarts[c];
+        multirate_filter_channel<ChunkSize>(loadedData.samples.data() + start + loadedData.padding, loadedData.channelLengths[c],
+                                            outputBuffer.data() + start, config, lowKernel);
+    }
+}
+
+#endif // CONVOLVE_MULTIRATE
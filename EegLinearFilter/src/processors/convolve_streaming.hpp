@@ -0,0 +1,171 @@
+//
+//  convolve_streaming.hpp
+//  EegLinearFilter
+//
+//  Manually vectorized convolution writing each output once with non-temporal stores.
+//
+
+#ifndef CONVOLVE_STREAMING
+#define CONVOLVE_STREAMING
+
+#include "../config.h"
+#include "../data_types.hpp"
+#include <dispatch/dispatch.h>
+#include <arm_neon.h>
+#include <algorithm>
+#include <vector>
+
+/**
+ * Sums KBatch taps for 16 consecutive outputs (four output vectors, four accumulators each),
+ * the same register tiling as the manual-vector kernels.
+ */
+template <int KBatch>
+inline void manual_vec_batch(const float* __restrict current_d, const float* __restrict k_ptr_base, float32x4_t (&sums)[4]) {
+    float32x4_t acc0_A = vdupq_n_f32(0.0f); float32x4_t acc1_A = vdupq_n_f32(0.0f);
+    float32x4_t acc2_A = vdupq_n_f32(0.0f); float32x4_t acc3_A = vdupq_n_f32(0.0f);
+    float32x4_t acc0_B = vdupq_n_f32(0.0f); float32x4_t acc1_B = vdupq_n_f32(0.0f);
+    float32x4_t acc2_B = vdupq_n_f32(0.0f); float32x4_t acc3_B = vdupq_n_f32(0.0f);
+    float32x4_t acc0_C = vdupq_n_f32(0.0f); float32x4_t acc1_C = vdupq_n_f32(0.0f);
+    float32x4_t acc2_C = vdupq_n_f32(0.0f); float32x4_t acc3_C = vdupq_n_f32(0.0f);
+    float32x4_t acc0_D = vdupq_n_f32(0.0f); float32x4_t acc1_D = vdupq_n_f32(0.0f);
+    float32x4_t acc2_D = vdupq_n_f32(0.0f); float32x4_t acc3_D = vdupq_n_f32(0.0f);
+
+    for (int i = 0; i < KBatch; i += 4) {
+        float32x4_t k0 = vdupq_n_f32(k_ptr_base[i + 0]);
+        float32x4_t k1 = vdupq_n_f32(k_ptr_base[i + 1]);
+        float32x4_t k2 = vdupq_n_f32(k_ptr_base[i + 2]);
+        float32x4_t k3 = vdupq_n_f32(k_ptr_base[i + 3]);
+
+        acc0_A = vfmaq_f32(acc0_A, vld1q_f32(current_d + i + 0), k0);
+        acc1_A = vfmaq_f32(acc1_A, vld1q_f32(current_d + i + 1), k1);
+        acc2_A = vfmaq_f32(acc2_A, vld1q_f32(current_d + i + 2), k2);
+        acc3_A = vfmaq_f32(acc3_A, vld1q_f32(current_d + i + 3), k3);
+
+        acc0_B = vfmaq_f32(acc0_B, vld1q_f32(current_d + i + 4), k0);
+        acc1_B = vfmaq_f32(acc1_B, vld1q_f32(current_d + i + 5), k1);
+        acc2_B = vfmaq_f32(acc2_B, vld1q_f32(current_d + i + 6), k2);
+        acc3_B = vfmaq_f32(acc3_B, vld1q_f32(current_d + i + 7), k3);
+
+        acc0_C = vfmaq_f32(acc0_C, vld1q_f32(current_d + i + 8), k0);
+        acc1_C = vfmaq_f32(acc1_C, vld1q_f32(current_d + i + 9), k1);
+        acc2_C = vfmaq_f32(acc2_C, vld1q_f32(current_d + i + 10), k2);
+        acc3_C = vfmaq_f32(acc3_C, vld1q_f32(current_d + i + 11), k3);
+
+        acc0_D = vfmaq_f32(acc0_D, vld1q_f32(current_d + i + 12), k0);
+        acc1_D = vfmaq_f32(acc1_D, vld1q_f32(current_d + i + 13), k1);
+        acc2_D = vfmaq_f32(acc2_D, vld1q_f32(current_d + i + 14), k2);
+        acc3_D = vfmaq_f32(acc3_D, vld1q_f32(current_d + i + 15), k3);
+    }
+
+    sums[0] = vaddq_f32(vaddq_f32(acc0_A, acc1_A), vaddq_f32(acc2_A, acc3_A));
+    sums[1] = vaddq_f32(vaddq_f32(acc0_B, acc1_B), vaddq_f32(acc2_B, acc3_B));
+    sums[2] = vaddq_f32(vaddq_f32(acc0_C, acc1_C), vaddq_f32(acc2_C, acc3_C));
+    sums[3] = vaddq_f32(vaddq_f32(acc0_D, acc1_D), vaddq_f32(acc2_D, acc3_D));
+}
+
+/**
+ * Convolves one chunk so that the output buffer is written exactly once.
+ * All kernel batches but the last accumulate into partial, a chunk-sized scratch that stays in L1/L2.
+ * The last batch (with the remaining taps) adds the partial sums and writes the outputs with non-temporal
+ * stores (STNP), so the output lines are neither read (write-allocate) nor kept in the cache. Meanwhile the
+ * input PrefetchDistance samples ahead is prefetched, which is the next chunk when it equals ChunkSize.
+ */
+template <int KBatch, int PrefetchDistance>
+inline void manual_vec_nt_chunk(const float* __restrict d_chunk, float* __restrict o_chunk, const size_t actualChunkSize, const float* __restrict kernelPtr, const size_t kernelSize, float* __restrict partial) {
+    const size_t numBatches = kernelSize / KBatch;
+    const size_t lastBatch = (numBatches > 0) ? (numBatches - 1) * KBatch : 0;
+    const size_t vecChunkSize = actualChunkSize & ~static_cast<size_t>(15);
+
+    std::fill(partial, partial + actualChunkSize, 0.0f);
+
+    for (size_t k = 0; k < lastBatch; k += KBatch) {
+        for (size_t out = 0; out < vecChunkSize; out += 16) {
+            float32x4_t sums[4];
+            manual_vec_batch<KBatch>(d_chunk + out + k, kernelPtr + k, sums);
+            for (int v = 0; v < 4; ++v) {
+                vst1q_f32(partial + out + 4 * v, vaddq_f32(vld1q_f32(partial + out + 4 * v), sums[v]));
+            }
+        }
+    }
+
+    const size_t tailStart = (numBatches > 0) ? lastBatch + KBatch : 0;
+
+    for (size_t out = 0; out < vecChunkSize; out += 16) {
+        __builtin_prefetch(d_chunk + out + PrefetchDistance, 0, 3);
+
+        float32x4_t sums[4] = {vdupq_n_f32(0.0f), vdupq_n_f32(0.0f), vdupq_n_f32(0.0f), vdupq_n_f32(0.0f)};
+        if (numBatches > 0) {
+            manual_vec_batch<KBatch>(d_chunk + out + lastBatch, kernelPtr + lastBatch, sums);
+        }
+        for (size_t k = tailStart; k < kernelSize; ++k) {
+            const float32x4_t kv = vdupq_n_f32(kernelPtr[k]);
+            for (int v = 0; v < 4; ++v) {
+                sums[v] = vfmaq_f32(sums[v], vld1q_f32(d_chunk + out + k + 4 * v), kv);
+            }
+        }
+        for (int v = 0; v < 4; ++v) {
+            const float32x4_t result = vaddq_f32(vld1q_f32(partial + out + 4 * v), sums[v]);
+            __builtin_nontemporal_store(result, reinterpret_cast<float32x4_t*>(o_chunk + out + 4 * v));
+        }
+    }
+
+    for (size_t out = vecChunkSize; out < actualChunkSize; ++out) {
+        float acc = 0.0f;
+        for (size_t k = 0; k < kernelSize; ++k) acc += d_chunk[out + k] * kernelPtr[k];
+        o_chunk[out] = acc;
+    }
+}
+
+/**
+ * Sequential manual-vector implementation with a write-once output stage (non-temporal stores)
+ * and software prefetch of the next chunk.
+ *
+ * @tparam Radius Kernel radius.
+ * @tparam ChunkSize Elements per block.
+ * @tparam KBatch Kernel taps per pass.
+ */
+template <int Radius, int ChunkSize, int KBatch>
+void convolve_seq_manual_vec_nt(const NeonVector& data, NeonVector& outputBuffer, const std::vector<float>& convolutionKernel) {
+    constexpr size_t KernelSize = 2 * Radius + 1;
+    const size_t outSize = data.size() - KernelSize + 1;
+
+    const float* __restrict dataPtr = data.data();
+    float* __restrict outputPtr = outputBuffer.data();
+    const float* __restrict kernelPtr = convolutionKernel.data();
+
+    alignas(64) float partial[ChunkSize];
+
+    for (size_t start = 0; start < outSize; start += ChunkSize) {
+        const size_t actualChunkSize = std::min(static_cast<size_t>(ChunkSize), outSize - start);
+        manual_vec_nt_chunk<KBatch, PREFETCH_DISTANCE>(dataPtr + start, outputPtr + start, actualChunkSize, kernelPtr, KernelSize, partial);
+    }
+}
+
+/**
+ * Parallel manual-vector implementation with a write-once output stage (non-temporal stores)
+ * and software prefetch. Every task keeps its partial sums on its own stack.
+ *
+ * @tparam Radius Kernel radius.
+ * @tparam ChunkSize Elements per task.
+ * @tparam KBatch Kernel taps per pass.
+ */
+template <int Radius, int ChunkSize, int KBatch>
+void convolve_par_manual_vec_nt(const NeonVector& data, NeonVector& outputBuffer, const std::vector<float>& convolutionKernel) {
+    constexpr size_t KernelSize = 2 * Radius + 1;
+    const size_t outSize = data.size() - KernelSize + 1;
+
+    const float* __restrict dataPtr = data.data();
+    float* __restrict outputPtr = outputBuffer.data();
+    const float* __restrict kernelPtr = convolutionKernel.data();
+    const size_t numChunks = (outSize + ChunkSize - 1) / ChunkSize;
+
+    dispatch_apply(numChunks, dispatch_get_global_queue(QOS_CLASS_USER_INTERACTIVE, 0), ^(size_t chunkIndex) {
+        const size_t start = chunkIndex * ChunkSize;
+        const size_t actualChunkSize = std::min(static_cast<size_t>(ChunkSize), outSize - start);
+
+        alignas(64) float partial[ChunkSize];
+        manual_vec_nt_chunk<KBatch, PREFETCH_DISTANCE>(dataPtr + start, outputPtr + start, actualChunkSize, kernelPtr, KernelSize, partial);
+    });
+}
+
+#endif // CONVOLVE_STREAMING
@@ -0,0 +1,191 @@
+//
+//  convolve_toeplitz.hpp
+//  EegLinearFilter
+//
+//  Convolution recast as a Toeplitz x data-panel matrix product evaluated by a register-tiled micro-kernel.
+//
+
+#ifndef CONVOLVE_TOEPLITZ
+#define CONVOLVE_TOEPLITZ
+
+#include "../data_types.hpp"
+#include <dispatch/dispatch.h>
+#include <arm_neon.h>
+#include <algorithm>
+#include <vector>
+
+/**
+ * Kernel packed into the Toeplitz panels consumed by the micro-kernel.
+ *
+ * Tap k = 4 * c + s is stored in panel s (phase of the tap within a Neon vector) at group c.
+ * Each panel is reversed and zero-padded by MR - 1 groups on both sides, so for every data vector m
+ * the coefficients of all MR accumulators are one contiguous, forward run of the panel.
+ */
+struct ToeplitzPanels {
+    std::vector<float> values;
+    size_t groups;   // Number of 4-tap groups (C).
+    size_t stride;   // Length of one panel (multiple of 4).
+};
+
+/**
+ * Packs the kernel into Toeplitz panels for a micro-kernel with MR accumulators.
+ */
+template <int MR>
+ToeplitzPanels pack_toeplitz_panels(const std::vector<float>& convolutionKernel) {
+    const size_t kernelSize = convolutionKernel.size();
+    const size_t groups = (kernelSize + 3) / 4;
+    const size_t length = groups + 2 * MR - 2;
+    const size_t stride = (length + 3) / 4 * 4;
+
+    ToeplitzPanels panels { std::vector<float>(4 * stride, 0.0f), groups, stride };
+
+    for (size_t s = 0; s < 4; ++s) {
+        float* panel = panels.values.data() + s * stride;
+        for (size_t u = 0; u < length; ++u) {
+            const long long c = static_cast<long long>(groups + MR - 2) - static_cast<long long>(u);
+            const long long k = 4 * c + static_cast<long long>(s);
+            if (c >= 0 && c < static_cast<long long>(groups) && k < static_cast<long long>(kernelSize)) {
+                panel[u] = convolutionKernel[k];
+            }
+        }
+    }
+    return panels;
+}
+
+/**
+ * Register-tiled micro-kernel computing 4 * MR consecutive outputs.
+ *
+ * Each (unaligned) data vector is loaded once per tap phase and reused by all MR accumulators,
+ * instead of being reloaded for every tap offset as in the K_BATCH loops.
+ *
+ * @param d Input starting at the first output's window.
+ * @param o Destination of 4 * MR outputs (overwritten).
+ */
+template <int MR>
+inline void toeplitz_micro_kernel(const float* __restrict d, float* __restrict o, const ToeplitzPanels& panels) {
+    static_assert(MR % 4 == 0, "MR must be a multiple of 4.");
+
+    float32x4_t acc[MR];
+    #pragma clang loop unroll(full)
+    for (int a = 0; a < MR; ++a) acc[a] = vdupq_n_f32(0.0f);
+
+    const size_t steps = panels.groups + MR - 1;
+
+    for (size_t s = 0; s < 4; ++s) {
+        const float* panel = panels.values.data() + s * panels.stride + (steps - 1);
+        const float* current_d = d + s;
+
+        for (size_t m = 0; m < steps; ++m) {
+            const float32x4_t v = vld1q_f32(current_d + 4 * m);
+            const float* q = panel - m;
+
+            #pragma clang loop unroll(full)
+            for (int a = 0; a < MR; a += 4) {
+                const float32x4_t coef = vld1q_f32(q + a);
+                acc[a + 0] = vfmaq_laneq_f32(acc[a + 0], v, coef, 0);
+                acc[a + 1] = vfmaq_laneq_f32(acc[a + 1], v, coef, 1);
+                acc[a + 2] = vfmaq_laneq_f32(acc[a + 2], v, coef, 2);
+                acc[a + 3] = vfmaq_laneq_f32(acc[a + 3], v, coef, 3);
+            }
+        }
+    }
+
+    #pragma clang loop unroll(full)
+    for (int a = 0; a < MR; ++a) vst1q_f32(o + 4 * a, acc[a]);
+}
+
+/**
+ * Processes one L2-resident block of outputs with the micro-kernel (scalar tail).
+ */
+template <int MR>
+inline void toeplitz_block(const float* __restrict d_chunk, float* __restrict o_chunk, const size_t actualChunkSize, const ToeplitzPanels& panels, const float* __restrict kernelPtr, const size_t kernelSize) {
+    constexpr size_t TileSize = 4 * MR;
+    size_t out = 0;
+
+    for (; out + TileSize <= actualChunkSize; out += TileSize) {
+        toeplitz_micro_kernel<MR>(d_chunk + out, o_chunk + out, panels);
+    }
+
+    for (; out < actualChunkSize; ++out) {
+        float acc = 0.0f;
+        for (size_t k = 0; k < kernelSize; ++k) acc += d_chunk[out + k] * kernelPtr[k];
+        o_chunk[out] = acc;
+    }
+}
+
+/**
+ * Sequential Toeplitz-GEMM implementation.
+ *
+ * Every CHUNK_SIZE block (L2 blocking) is the product of the banded Toeplitz matrix of the kernel
+ * with the block's data panel. The micro-kernel keeps an MR x 4 output tile in registers.
+ *
+ * @tparam Radius Kernel radius.
+ * @tparam ChunkSize Elements per block.
+ * @tparam MR Number of Neon accumulators in the register tile (8 or 16).
+ */
+template <int Radius, int ChunkSize, int MR>
+void convolve_seq_toeplitz_gemm(const NeonVector& data, NeonVector& outputBuffer, const std::vector<float>& convolutionKernel) {
+    constexpr size_t KernelSize = 2 * Radius + 1;
+    const size_t outSize = data.size() - KernelSize + 1;
+
+    const ToeplitzPanels panels = pack_toeplitz_panels<MR>(convolutionKernel);
+
+    const float* __restrict dataPtr = data.data();
+    float* __restrict outputPtr = outputBuffer.data();
+    const float* __restrict kernelPtr = convolutionKernel.data();
+
+    // The micro-kernel reads whole 4-tap groups, the last block falls back to the scalar path to stay in bounds.
+    const size_t safeOutSize = (data.size() >= 4 * panels.groups + 4 * MR) ? std::min(outSize, data.size() - 4 * panels.groups + 1) : 0;
+
+    for (size_t start = 0; start < outSize; start += ChunkSize) {
+        const size_t actualChunkSize = std::min(static_cast<size_t>(ChunkSize), outSize - start);
+        const size_t tiledSize = (start < safeOutSize) ? std::min(actualChunkSize, safeOutSize - start) : 0;
+
+        toeplitz_block<MR>(dataPtr + start, outputPtr + start, tiledSize, panels, kernelPtr, KernelSize);
+
+        for (size_t out = tiledSize; out < actualChunkSize; ++out) {
+            float acc = 0.0f;
+            for (size_t k = 0; k < KernelSize; ++k) acc += dataPtr[start + out + k] * kernelPtr[k];
+            outputPtr[start + out] = acc;
+        }
+    }
+}
+
+/**
+ * Parallel Toeplitz-GEMM implementation (one GCD task per CHUNK_SIZE block).
+ *
+ * @tparam Radius Kernel radius.
+ * @tparam ChunkSize Elements per task.
+ * @tparam MR Number of Neon accumulators in the register tile (8 or 16).
+ */
+template <int Radius, int ChunkSize, int MR>
+void convolve_par_toeplitz_gemm(const NeonVector& data, NeonVector& outputBuffer, const std::vector<float>& convolutionKernel) {
+    constexpr size_t KernelSize = 2 * Radius + 1;
+    const size_t outSize = data.size() - KernelSize + 1;
+
+    const ToeplitzPanels panels = pack_toeplitz_panels<MR>(convolutionKernel);
+    const ToeplitzPanels* panelsPtr = &panels;
+
+    const float* __restrict dataPtr = data.data();
+    float* __restrict outputPtr = outputBuffer.data();
+    const float* __restrict kernelPtr = convolutionKernel.data();
+
+    const size_t safeOutSize = (data.size() >= 4 * panels.groups + 4 * MR) ? std::min(outSize, data.size() - 4 * panels.groups + 1) : 0;
+    const size_t numChunks = (outSize + ChunkSize - 1) / ChunkSize;
+
+    dispatch_apply(numChunks, dispatch_get_global_queue(QOS_CLASS_USER_INTERACTIVE, 0), ^(size_t chunkIndex) {
+        const size_t start = chunkIndex * ChunkSize;
+        const size_t actualChunkSize = std::min(static_cast<size_t>(ChunkSize), outSize - start);
+        const size_t tiledSize = (start < safeOutSize) ? std::min(actualChunkSize, safeOutSize - start) : 0;
+
+        toeplitz_block<MR>(dataPtr + start, outputPtr + start, tiledSize, *panelsPtr, kernelPtr, KernelSize);
+
+        for (size_t out = tiledSize; out < actualChunkSize; ++out) {
+            float acc = 0.0f;
+            for (size_t k = 0; k < KernelSize; ++k) acc += dataPtr[start + out + k] * kernelPtr[k];
+            outputPtr[start + out] = acc;
+        }
+    });
+}
+
+#endif // CONVOLVE_TOEPLITZ
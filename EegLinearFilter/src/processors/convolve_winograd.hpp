@@ -0,0 +1,253 @@
+//
+//  convolve_winograd.hpp
+//  EegLinearFilter
+//
+//  Winograd minimal-filtering F(m, 3) convolution nested over 3-tap segments of the kernel.
+//
+
+#ifndef CONVOLVE_WINOGRAD
+#define CONVOLVE_WINOGRAD
+
+#include "../data_types.hpp"
+#include <dispatch/dispatch.h>
+#include <arm_neon.h>
+#include <algorithm>
+#include <vector>
+
+/**
+ * Kernel split into 3-tap segments and transformed into the Winograd domain.
+ *
+ * Segments are dilated by the Neon width: segment (s, q) holds taps s + 4 * (3q + t), t = 0..2.
+ * With that layout the m + 2 input vectors of a tile are plain contiguous loads and every lane
+ * computes its own F(m, 3) tile. Missing taps at the end of the kernel are zero.
+ * Values are stored as [(s * groups + q) * (M + 2) + u].
+ */
+struct WinogradFilter {
+    std::vector<float> values;
+    size_t groups;   // Number of segments per phase.
+};
+
+/**
+ * Transforms a 3-tap segment (U = G g). Evaluated in double, the rounding happens only once per weight.
+ */
+template <int M>
+inline void winograd_filter_transform(const double g0, const double g1, const double g2, float* u) {
+    static_assert(M == 2 || M == 4, "Only F(2, 3) and F(4, 3) are implemented.");
+
+    if constexpr (M == 2) {
+        u[0] = static_cast<float>(g0);
+        u[1] = static_cast<float>((g0 + g1 + g2) / 2.0);
+        u[2] = static_cast<float>((g0 - g1 + g2) / 2.0);
+        u[3] = static_cast<float>(g2);
+    } else {
+        u[0] = static_cast<float>(g0 / 4.0);
+        u[1] = static_cast<float>(-(g0 + g1 + g2) / 6.0);
+        u[2] = static_cast<float>(-(g0 - g1 + g2) / 6.0);
+        u[3] = static_cast<float>(g0 / 24.0 + g1 / 12.0 + g2 / 6.0);
+        u[4] = static_cast<float>(g0 / 24.0 - g1 / 12.0 + g2 / 6.0);
+        u[5] = static_cast<float>(g2);
+    }
+}
+
+/**
+ * Precomputes the transformed kernel segments for F(M, 3).
+ */
+template <int M>
+WinogradFilter pack_winograd_filter(const std::vector<float>& convolutionKernel) {
+    const size_t kernelSize = convolutionKernel.size();
+    const size_t groups = ((kernelSize + 3) / 4 + 2) / 3;
+
+    WinogradFilter filter { std::vector<float>(4 * groups * (M + 2)), groups };
+
+    auto tap = [&](size_t k) { return (k < kernelSize) ? static_cast<double>(convolutionKernel[k]) : 0.0; };
+
+    for (size_t s = 0; s < 4; ++s) {
+        for (size_t q = 0; q < groups; ++q) {
+            const size_t k = s + 12 * q;
+            winograd_filter_transform<M>(tap(k), tap(k + 4), tap(k + 8), filter.values.data() + (s * groups + q) * (M + 2));
+        }
+    }
+    return filter;
+}
+
+/**
+ * Input transform (V = B^T d), additions and multiplications by small powers of two only.
+ */
+template <int M>
+inline void winograd_input_transform(const float32x4_t* v, float32x4_t* t) {
+    if constexpr (M == 2) {
+        t[0] = vsubq_f32(v[0], v[2]);
+        t[1] = vaddq_f32(v[1], v[2]);
+        t[2] = vsubq_f32(v[2], v[1]);
+        t[3] = vsubq_f32(v[1], v[3]);
+    } else {
+        const float32x4_t v4m2 = vsubq_f32(v[4], v[2]);
+        const float32x4_t v3m1 = vsubq_f32(v[3], v[1]);
+        const float32x4_t a = vfmaq_n_f32(v[4], v[2], -4.0f);  // v4 - 4 v2
+        const float32x4_t b = vfmaq_n_f32(v[3], v[1], -4.0f);  // v3 - 4 v1
+
+        t[0] = vfmaq_n_f32(vfmaq_n_f32(v[4], v[0], 4.0f), v[2], -5.0f);
+        t[1] = vaddq_f32(a, b);
+        t[2] = vsubq_f32(a, b);
+        t[3] = vfmaq_n_f32(v4m2, v3m1, 2.0f);
+        t[4] = vfmaq_n_f32(v4m2, v3m1, -2.0f);
+        t[5] = vfmaq_n_f32(vfmaq_n_f32(v[5], v[1], 4.0f), v[3], -5.0f);
+    }
+}
+
+/**
+ * Output transform (y = A^T m), stores M vectors of 4 consecutive outputs.
+ */
+template <int M>
+inline void winograd_output_transform(const float32x4_t* m, float* __restrict o) {
+    if constexpr (M == 2) {
+        vst1q_f32(o + 0, vaddq_f32(vaddq_f32(m[0], m[1]), m[2]));
+        vst1q_f32(o + 4, vsubq_f32(vsubq_f32(m[1], m[2]), m[3]));
+    } else {
+        const float32x4_t p12 = vaddq_f32(m[1], m[2]);
+        const float32x4_t m12 = vsubq_f32(m[1], m[2]);
+        const float32x4_t p34 = vaddq_f32(m[3], m[4]);
+        const float32x4_t m34 = vsubq_f32(m[3], m[4]);
+
+        vst1q_f32(o + 0, vaddq_f32(vaddq_f32(m[0], p12), p34));
+        vst1q_f32(o + 4, vfmaq_n_f32(m12, m34, 2.0f));
+        vst1q_f32(o + 8, vfmaq_n_f32(p12, p34, 4.0f));
+        vst1q_f32(o + 12, vaddq_f32(vfmaq_n_f32(m12, m34, 8.0f), m[5]));
+    }
+}
+
+/**
+ * Computes 4 * M consecutive outputs. The element-wise products of all segments are summed
+ * in the Winograd domain, so only one output transform is needed per tile.
+ *
+ * @param d Input starting at the first output's window.
+ * @param o Destination of 4 * M outputs (overwritten).
+ */
+template <int M>
+inline void winograd_tile(const float* __restrict d, float* __restrict o, const WinogradFilter& filter) {
+    float32x4_t acc[M + 2];
+    #pragma clang loop unroll(full)
+    for (int u = 0; u < M + 2; ++u) acc[u] = vdupq_n_f32(0.0f);
+
+    for (size_t s = 0; s < 4; ++s) {
+        const float* __restrict current_d = d + s;
+        const float* __restrict current_u = filter.values.data() + s * filter.groups * (M + 2);
+
+        for (size_t q = 0; q < filter.groups; ++q) {
+            float32x4_t v[M + 2];
+            float32x4_t t[M + 2];
+
+            #pragma clang loop unroll(full)
+            for (int u = 0; u < M + 2; ++u) v[u] = vld1q_f32(current_d + 4 * u);
+
+            winograd_input_transform<M>(v, t);
+
+            #pragma clang loop unroll(full)
+            for (int u = 0; u < M + 2; ++u) acc[u] = vfmaq_n_f32(acc[u], t[u], current_u[u]);
+
+            current_d += 12;
+            current_u += M + 2;
+        }
+    }
+
+    winograd_output_transform<M>(acc, o);
+}
+
+/**
+ * Processes one block of outputs tile by tile (scalar tail).
+ */
+template <int M>
+inline void winograd_block(const float* __restrict d_chunk, float* __restrict o_chunk, const size_t actualChunkSize, const WinogradFilter& filter, const float* __restrict kernelPtr, const size_t kernelSize) {
+    constexpr size_t TileSize = 4 * M;
+    size_t out = 0;
+
+    for (; out + TileSize <= actualChunkSize; out += TileSize) {
+        winograd_tile<M>(d_chunk + out, o_chunk + out, filter);
+    }
+
+    for (; out < actualChunkSize; ++out) {
+        float acc = 0.0f;
+        for (size_t k = 0; k < kernelSize; ++k) acc += d_chunk[out + k] * kernelPtr[k];
+        o_chunk[out] = acc;
+    }
+}
+
+/**
+ * Sequential Winograd F(M, 3) implementation.
+ *
+ * The kernel is nested into 3-tap segments, each tile then needs M + 2 multiplications per segment
+ * instead of 3 * M. Larger tiles save more multiplications but amplify rounding errors
+ * (the F(4, 3) transforms contain factors up to 8 and 1/24), see WINOGRAD_TILE.
+ *
+ * @tparam Radius Kernel radius.
+ * @tparam ChunkSize Elements per block.
+ * @tparam M Outputs per tile and lane (2 or 4).
+ */
+template <int Radius, int ChunkSize, int M>
+void convolve_seq_winograd(const NeonVector& data, NeonVector& outputBuffer, const std::vector<float>& convolutionKernel) {
+    constexpr size_t KernelSize = 2 * Radius + 1;
+    const size_t outSize = data.size() - KernelSize + 1;
+
+    const WinogradFilter filter = pack_winograd_filter<M>(convolutionKernel);
+
+    const float* __restrict dataPtr = data.data();
+    float* __restrict outputPtr = outputBuffer.data();
+    const float* __restrict kernelPtr = convolutionKernel.data();
+
+    // Tiles read the zero-padded segments as well, the last outputs fall back to the scalar path to stay in bounds.
+    const size_t paddedSpan = 12 * filter.groups;
+    const size_t safeOutSize = (data.size() >= paddedSpan) ? std::min(outSize, data.size() - paddedSpan + 1) : 0;
+
+    for (size_t start = 0; start < outSize; start += ChunkSize) {
+        const size_t actualChunkSize = std::min(static_cast<size_t>(ChunkSize), outSize - start);
+        const size_t tiledSize = (start < safeOutSize) ? std::min(actualChunkSize, safeOutSize - start) : 0;
+
+        winograd_block<M>(dataPtr + start, outputPtr + start, tiledSize, filter, kernelPtr, KernelSize);
+
+        for (size_t out = tiledSize; out < actualChunkSize; ++out) {
+            float acc = 0.0f;
+            for (size_t k = 0; k < KernelSize; ++k) acc += dataPtr[start + out + k] * kernelPtr[k];
+            outputPtr[start + out] = acc;
+        }
+    }
+}
+
+/**
+ * Parallel Winograd F(M, 3) implementation (one GCD task per CHUNK_SIZE block).
+ *
+ * @tparam Radius Kernel radius.
+ * @tparam ChunkSize Elements per task.
+ * @tparam M Outputs per tile and lane (2 or 4).
+ */
+template <int Radius, int ChunkSize, int M>
+void convolve_par_winograd(const NeonVector& data, NeonVector& outputBuffer, const std::vector<float>& convolutionKernel) {
+    constexpr size_t KernelSize = 2 * Radius + 1;
+    const size_t outSize = data.size() - KernelSize + 1;
+
+    const WinogradFilter filter = pack_winograd_filter<M>(convolutionKernel);
+    const WinogradFilter* filterPtr = &filter;
+
+    const float* __restrict dataPtr = data.data();
+    float* __restrict outputPtr = outputBuffer.data();
+    const float* __restrict kernelPtr = convolutionKernel.data();
+
+    const size_t paddedSpan = 12 * filter.groups;
+    const size_t safeOutSize = (data.size() >= paddedSpan) ? std::min(outSize, data.size() - paddedSpan + 1) : 0;
+    const size_t numChunks = (outSize + ChunkSize - 1) / ChunkSize;
+
+    dispatch_apply(numChunks, dispatch_get_global_queue(QOS_CLASS_USER_INTERACTIVE, 0), ^(size_t chunkIndex) {
+        const size_t start = chunkIndex * ChunkSize;
+        const size_t actualChunkSize = std::min(static_cast<size_t>(ChunkSize), outSize - start);
+        const size_t tiledSize = (start < safeOutSize) ? std::min(actualChunkSize, safeOutSize - start) : 0;
+
+        winograd_block<M>(dataPtr + start, outputPtr + start, tiledSize, *filterPtr, kernelPtr, KernelSize);
+
+        for (size_t out = tiledSize; out < actualChunkSize; ++out) {
+            float acc = 0.0f;
+            for (size_t k = 0; k < KernelSize; ++k) acc += dataPtr[start + out + k] * kernelPtr[k];
+            outputPtr[start + out] = acc;
+        }
+    });
+}
+
+#endif // CONVOLVE_WINOGRAD
@@ -12,9 +12,82 @@
 #include "../config.h"
 #include "convolve_par.hpp"
 #include "convolve_seq.hpp"
+#include "convolve_toeplitz.hpp"
+#include "convolve_winograd.hpp"
+#include "convolve_fft.hpp"
+#include "convolve_fp16.hpp"
+#include "convolve_int16.hpp"
+#include "convolve_fused.hpp"
+#include "convolve_compensated.hpp"
+#include "convolve_in_place.hpp"
+#include "convolve_streaming.hpp"
+#include "convolve_multirate.hpp"
+#include "convolve_box_cascade.hpp"
 #include "convolve_gpu/convolve_gpu.hpp"
 #include <chrono>
 
+/**
+ * Returns the sample representation the mode needs in memory.
+ *
+ * @param mode The processing mode.
+ * @return INT16 for the fixed-point modes, FLOAT16 for the FP16-storage modes, NONE for the fused modes
+ *         (they read the file), FLOAT32 otherwise.
+ */
+inline SampleFormat required_sample_format(const ProcessingMode mode) {
+    switch (mode) {
+        case ProcessingMode::CPU_SEQ_INT16:
+        case ProcessingMode::CPU_PAR_INT16:
+            return SampleFormat::INT16;
+        case ProcessingMode::CPU_SEQ_FP16:
+        case ProcessingMode::CPU_PAR_FP16:
+            return SampleFormat::FLOAT16;
+        case ProcessingMode::CPU_PAR_FUSED_DECODE:
+            return SampleFormat::NONE;
+        default:
+            return SampleFormat::FLOAT32;
+    }
+}
+
+/**
+ * Returns whether the mode works on the 16-bit digital samples (fixed-point and fused modes),
+ * which 24-bit BDF files do not provide.
+ */
+inline bool requires_16bit_samples(const ProcessingMode mode) {
+    const SampleFormat format = required_sample_format(mode);
+    return format == SampleFormat::INT16 || format == SampleFormat::NONE;
+}
+
+/**
+ * Returns whether the mode quantizes its tiles straight into EDF records (fused output stage).
+ * Other modes fill the float output buffer first and quantize it in a separate pass.
+ */
+inline bool supports_fused_record_output(const ProcessingMode mode) {
+    return mode == ProcessingMode::CPU_SEQ_INT16 || mode == ProcessingMode::CPU_PAR_INT16 || mode == ProcessingMode::CPU_PAR_FUSED_DECODE;
+}
+
+/**
+ * Returns whether the mode runs on the GPU (all GPU modes share one Metal device and command queue).
+ */
+inline bool runs_on_gpu(const ProcessingMode mode) {
+    return mode == ProcessingMode::GPU_NAIVE || mode == ProcessingMode::GPU_32BIT;
+}
+
+/**
+ * Returns whether the mode filters the output buffer in place. It starts from a copy of the samples,
+ * or from the samples themselves when the caller handed them over (loaded samples left empty).
+ */
+inline bool filters_in_place(const ProcessingMode mode) {
+    return mode == ProcessingMode::CPU_PAR_IN_PLACE;
+}
+
+/**
+ * Returns whether the mode writes every output exactly once with non-temporal stores. Such modes need no
+ * zeroed output buffer, clearing it first would pull the lines into the cache the stores bypass.
+ */
+inline bool writes_output_once(const ProcessingMode mode) {
+    return mode == ProcessingMode::CPU_SEQ_MANUAL_VEC_NT || mode == ProcessingMode::CPU_PAR_MANUAL_VEC_NT;
+}
+
 /**
  * Executes a convolution processor based on the selected mode.
  * Measures time taken for memory initialization and computation.
@@ -23,22 +96,41 @@
  * @tparam ChunkSize Size of data chunks for processing.
  * @tparam KBatch Unrolling batch size.
  * @param mode Enum indicating which processor implementation to run (CPU/GPU, Seq/Par).
- * @param inputData The raw input signal.
- * @param outputBuffer The buffer to store processed results.
+ * @param loadedData The loaded EDF data (padded input signal and channel layout).
+ * @param outputBuffer The buffer to store processed results (holds the input for in-place modes when the samples were handed over).
  * @param convolutionKernel The filter kernel.
+ * @param recordOutput Optional EDF record output. Fused modes quantize into it directly, the other modes
+ *                     quantize the float output afterwards (timed as a memory operation).
  * @return ProcessingStats structure containing timing metrics.
  */
 template <int Radius, int ChunkSize, int KBatch>
-ProcessingStats run_processor(const ProcessingMode mode, const NeonVector& inputData, NeonVector& outputBuffer, const std::vector<float>& convolutionKernel) {
+ProcessingStats run_processor(const ProcessingMode mode, const EdfData& loadedData, NeonVector& outputBuffer, const std::vector<float>& convolutionKernel, EdfRecordOutput* recordOutput = nullptr) {
+    const NeonVector& inputData = loadedData.samples;
+    const bool samplesHandedOver = filters_in_place(mode) && inputData.empty();
+    if (inputData.empty() && required_sample_format(mode) == SampleFormat::FLOAT32 && !samplesHandedOver) {
+        throw std::runtime_error("Mode requires physical samples (not loaded)");
+    }
+    if (loadedData.halfSamples.empty() && required_sample_format(mode) == SampleFormat::FLOAT16) {
+        throw std::runtime_error("Mode requires FP16 samples (not loaded)");
+    }
+
     auto mem_start = std::chrono::high_resolution_clock::now();
-    std::fill(outputBuffer.begin(), outputBuffer.end(), 0.0f);
+    if (writes_output_once(mode)) {
+        // Only the last 2 * Radius elements (no output sample lands there) are left unwritten.
+        std::fill(outputBuffer.end() - std::min(outputBuffer.size(), static_cast<size_t>(2 * Radius)), outputBuffer.end(), 0.0f);
+    } else if (!filters_in_place(mode)) {
+        std::fill(outputBuffer.begin(), outputBuffer.end(), 0.0f);
+    } else if (!samplesHandedOver) {
+        std::copy(inputData.begin(), inputData.end(), outputBuffer.begin());
+    }
     auto mem_end = std::chrono::high_resolution_clock::now();
     double memoryTime = std::chrono::duration<double>(mem_end - mem_start).count();
 
     const auto start = std::chrono::high_resolution_clock::now();
     
-    ProcessingStats gpuStats = {0.0, 0.0, 0.0, 0.0, 0.0};
-    bool isGpu = false;
+    // GPU and FP16 modes time their own transfers / output conversions.
+    ProcessingStats selfTimedStats = {0.0, 0.0, 0.0, 0.0, 0.0};
+    bool isSelfTimed = false;
 
     switch (mode) {
         case ProcessingMode::CPU_SEQ_APPLE:
@@ -56,6 +148,16 @@ ProcessingStats run_processor(const ProcessingMode mode, const NeonVector& input
         case ProcessingMode::CPU_SEQ_MANUAL_VEC:
             convolve_seq_manual_vec<Radius, ChunkSize, KBatch>(inputData, outputBuffer, convolutionKernel);
             break;
+        case ProcessingMode::CPU_SEQ_TOEPLITZ_GEMM:
+            convolve_seq_toeplitz_gemm<Radius, ChunkSize, GEMM_MR>(inputData, outputBuffer, convolutionKernel);
+            break;
+        case ProcessingMode::CPU_SEQ_WINOGRAD:
+            convolve_seq_winograd<Radius, ChunkSize, WINOGRAD_TILE>(inputData, outputBuffer, convolutionKernel);
+            break;
+        case ProcessingMode::CPU_SEQ_FP16:
+            selfTimedStats = convolve_seq_fp16<Radius, ChunkSize, KBatch>(loadedData, outputBuffer, convolutionKernel);
+            isSelfTimed = true;
+            break;
         case ProcessingMode::CPU_PAR_NAIVE:
             convolve_par_naive<Radius, ChunkSize>(inputData, outputBuffer, convolutionKernel);
             break;
@@ -68,13 +170,62 @@ ProcessingStats run_processor(const ProcessingMode mode, const NeonVector& input
         case ProcessingMode::CPU_PAR_MANUAL_VEC:
             convolve_par_manual_vec<Radius, ChunkSize, KBatch>(inputData, outputBuffer, convolutionKernel);
             break;
+        case ProcessingMode::CPU_PAR_TOEPLITZ_GEMM:
+            convolve_par_toeplitz_gemm<Radius, ChunkSize, GEMM_MR>(inputData, outputBuffer, convolutionKernel);
+            break;
+        case ProcessingMode::CPU_SEQ_INT16:
+            convolve_seq_int16<Radius, ChunkSize>(loadedData, outputBuffer, convolutionKernel, recordOutput);
+            break;
+        case ProcessingMode::CPU_SEQ_NEUMAIER:
+            convolve_seq_neumaier<Radius, ChunkSize>(inputData, outputBuffer, convolutionKernel);
+            break;
+        case ProcessingMode::CPU_SEQ_FP64_ACC:
+            convolve_seq_fp64_acc<Radius, ChunkSize>(inputData, outputBuffer, convolutionKernel);
+            break;
+        case ProcessingMode::CPU_SEQ_MANUAL_VEC_NT:
+            convolve_seq_manual_vec_nt<Radius, ChunkSize, KBatch>(inputData, outputBuffer, convolutionKernel);
+            break;
+        case ProcessingMode::CPU_PAR_WINOGRAD:
+            convolve_par_winograd<Radius, ChunkSize, WINOGRAD_TILE>(inputData, outputBuffer, convolutionKernel);
+            break;
+        case ProcessingMode::CPU_PAR_MULTIRATE:
+            convolve_par_multirate<Radius, ChunkSize, KBatch>(loadedData, outputBuffer, convolutionKernel, KERNEL_SIGMA, MULTIRATE_TOLERANCE);
+            break;
+        case ProcessingMode::CPU_PAR_BOX_CASCADE:
+            convolve_par_box_cascade<Radius, ChunkSize>(inputData, outputBuffer, convolutionKernel, BOX_CASCADE_PASSES);
+            break;
+        case ProcessingMode::CPU_PAR_FP16:
+            selfTimedStats = convolve_par_fp16<Radius, ChunkSize, KBatch>(loadedData, outputBuffer, convolutionKernel);
+            isSelfTimed = true;
+            break;
+        case ProcessingMode::CPU_PAR_INT16:
+            convolve_par_int16<Radius, ChunkSize>(loadedData, outputBuffer, convolutionKernel, recordOutput);
+            break;
+        case ProcessingMode::CPU_PAR_FUSED_DECODE:
+            convolve_par_fused_decode<Radius, ChunkSize, GEMM_MR>(loadedData, outputBuffer, convolutionKernel, recordOutput);
+            break;
+        case ProcessingMode::CPU_PAR_FFT_BATCHED:
+            convolve_par_fft_batched<Radius, FFT_SIZE>(loadedData, outputBuffer, convolutionKernel);
+            break;
+        case ProcessingMode::CPU_PAR_NEUMAIER:
+            convolve_par_neumaier<Radius, ChunkSize>(inputData, outputBuffer, convolutionKernel);
+            break;
+        case ProcessingMode::CPU_PAR_FP64_ACC:
+            convolve_par_fp64_acc<Radius, ChunkSize>(inputData, outputBuffer, convolutionKernel);
+            break;
+        case ProcessingMode::CPU_PAR_IN_PLACE:
+            convolve_par_in_place<Radius, ChunkSize>(outputBuffer, convolutionKernel);
+            break;
+        case ProcessingMode::CPU_PAR_MANUAL_VEC_NT:
+            convolve_par_manual_vec_nt<Radius, ChunkSize, KBatch>(inputData, outputBuffer, convolutionKernel);
+            break;
         case ProcessingMode::GPU_NAIVE:
-            gpuStats = convolve_gpu_naive<Radius>(inputData, outputBuffer, convolutionKernel);
-            isGpu = true;
+            selfTimedStats = convolve_gpu_naive<Radius>(inputData, outputBuffer, convolutionKernel);
+            isSelfTimed = true;
             break;
         case ProcessingMode::GPU_32BIT:
-            gpuStats = convolve_gpu<Radius>(inputData, outputBuffer, convolutionKernel, false);
-            isGpu = true;
+            selfTimedStats = convolve_gpu<Radius>(inputData, outputBuffer, convolutionKernel, false);
+            isSelfTimed = true;
             break;
         default:
             throw std::runtime_error("Unknown processing mode");
@@ -82,11 +233,18 @@ ProcessingStats run_processor(const ProcessingMode mode, const NeonVector& input
     
     const auto end = std::chrono::high_resolution_clock::now();
     const std::chrono::duration<double> elapsed = end - start;
+
+    if (recordOutput && !supports_fused_record_output(mode)) {
+        const auto quantize_start = std::chrono::high_resolution_clock::now();
+        quantize_output_records<ChunkSize>(loadedData, outputBuffer, *recordOutput);
+        const auto quantize_end = std::chrono::high_resolution_clock::now();
+        memoryTime += std::chrono::duration<double>(quantize_end - quantize_start).count();
+    }
     
-    if (isGpu) {
-        gpuStats.cpuMemoryOpsSec += memoryTime;
-        gpuStats.totalTimeSec += memoryTime;
-        return gpuStats;
+    if (isSelfTimed) {
+        selfTimedStats.cpuMemoryOpsSec += memoryTime;
+        selfTimedStats.totalTimeSec += memoryTime;
+        return selfTimedStats;
     } else {
         double compute = elapsed.count();
         double total = compute + memoryTime;